@@ -453,6 +453,21 @@ public:
 
     /** Opens the default playback device. Returns an empty Device on error. */
     Device openPlayback(const std::nothrow_t&) noexcept;
+
+    /**
+     * Opens a loopback device, which renders the mix to a caller-provided
+     * buffer with Device::renderSamples instead of an audio output. The
+     * context attributes must specify the render format. Throws an exception
+     * on error.
+     *
+     * Requires the ALC_SOFT_loopback extension.
+     */
+    Device openLoopback(const String &name={});
+    Device openLoopback(const char *name);
+
+    /** Opens a loopback device. Returns an empty Device on error. */
+    Device openLoopback(const char *name, const std::nothrow_t&) noexcept;
+    Device openLoopback(const std::nothrow_t&) noexcept;
 };
 
 
@@ -595,6 +610,16 @@ public:
      */
     std::chrono::nanoseconds getClockTime();
 
+    /** Retrieves whether this device was opened with DeviceManager::openLoopback. */
+    bool isLoopback() const;
+
+    /**
+     * Renders the given number of sample frames of the mix to the buffer, in
+     * the format given to the context attributes. Only valid for loopback
+     * devices.
+     */
+    void renderSamples(ALCvoid *buffer, ALCsizei samples);
+
     /**
      * Closes and frees the device. All previously-created contexts must first
      * be destroyed.
@@ -1048,6 +1073,13 @@ public:
     /** Retrieves the source's priority. */
     ALuint getPriority() const;
 
+    /**
+     * Retrieves the number of times the stream played all its queued buffers
+     * before the background thread refilled it, since it was started. Always
+     * 0 for sources which don't play a stream.
+     */
+    uint64_t getUnderrunCount() const;
+
     /**
      * Sets the source's offset, in sample frames. If the source is playing or
      * paused, it will go to that offset immediately, otherwise the source will
@@ -74,6 +74,13 @@ DeviceImpl::DeviceImpl(const char *name)
     mPauseTime = mTimeBase = std::chrono::steady_clock::now().time_since_epoch();
 }
 
+DeviceImpl::DeviceImpl(ALCdevice *device, LPALCRENDERSAMPLESSOFT render_samples)
+  : mDevice(device), alcRenderSamplesSOFT(render_samples)
+{
+    setupExts();
+    mPauseTime = mTimeBase = std::chrono::steady_clock::now().time_since_epoch();
+}
+
 DeviceImpl::~DeviceImpl()
 {
     mContexts.clear();
@@ -322,6 +329,16 @@ std::chrono::nanoseconds DeviceImpl::getClockTime()
 }
 
 
+DECL_THUNK0(bool, Device, isLoopback, const)
+DECL_THUNK2(void, Device, renderSamples,, ALCvoid*, ALCsizei)
+void DeviceImpl::renderSamples(ALCvoid *buffer, ALCsizei samples)
+{
+    if(!alcRenderSamplesSOFT)
+        throw std::runtime_error("Device is not a loopback device");
+    alcRenderSamplesSOFT(mDevice, buffer, samples);
+}
+
+
 void Device::close()
 {
     DeviceImpl *i = pImpl;
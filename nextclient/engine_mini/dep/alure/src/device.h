@@ -33,6 +33,7 @@ class DeviceImpl {
 
 public:
     DeviceImpl(const char *name);
+    DeviceImpl(ALCdevice *device, LPALCRENDERSAMPLESSOFT render_samples);
     ~DeviceImpl();
 
     ALCdevice *getALCdevice() const { return mDevice; }
@@ -45,6 +46,8 @@ public:
     LPALCGETSTRINGISOFT alcGetStringiSOFT{nullptr};
     LPALCRESETDEVICESOFT alcResetDeviceSOFT{nullptr};
 
+    LPALCRENDERSAMPLESSOFT alcRenderSamplesSOFT{nullptr};
+
     void removeContext(ContextImpl *ctx);
 
     String getName(PlaybackName type) const;
@@ -69,6 +72,9 @@ public:
 
     std::chrono::nanoseconds getClockTime();
 
+    bool isLoopback() const { return alcRenderSamplesSOFT != nullptr; }
+    void renderSamples(ALCvoid *buffer, ALCsizei samples);
+
     void close();
 };
 
@@ -79,6 +79,11 @@ DeviceManagerImpl::DeviceManagerImpl()
 {
     if(alcIsExtensionPresent(nullptr, "ALC_EXT_thread_local_context"))
         GetDeviceProc(SetThreadContext, nullptr, "alcSetThreadContext");
+    if(alcIsExtensionPresent(nullptr, "ALC_SOFT_loopback"))
+    {
+        GetDeviceProc(alcLoopbackOpenDeviceSOFT, nullptr, "alcLoopbackOpenDeviceSOFT");
+        GetDeviceProc(alcRenderSamplesSOFT, nullptr, "alcRenderSamplesSOFT");
+    }
 }
 
 DeviceManagerImpl::~DeviceManagerImpl()
@@ -143,6 +148,34 @@ Device DeviceManagerImpl::openPlayback(const char *name, const std::nothrow_t&)
     return Device();
 }
 
+Device DeviceManager::openLoopback(const String &name)
+{ return openLoopback(name.c_str()); }
+DECL_THUNK1(Device, DeviceManager, openLoopback,, const char*)
+Device DeviceManagerImpl::openLoopback(const char *name)
+{
+    if(!alcLoopbackOpenDeviceSOFT || !alcRenderSamplesSOFT)
+        throw std::runtime_error("ALC_SOFT_loopback not supported");
+
+    ALCdevice *device = alcLoopbackOpenDeviceSOFT(name);
+    if(!device) throw alc_error(alcGetError(nullptr), "alcLoopbackOpenDeviceSOFT failed");
+
+    mDevices.emplace_back(MakeUnique<DeviceImpl>(device, alcRenderSamplesSOFT));
+    return Device(mDevices.back().get());
+}
+
+Device DeviceManager::openLoopback(const std::nothrow_t&) noexcept
+{ return openLoopback(nullptr, std::nothrow); }
+DECL_THUNK2(Device, DeviceManager, openLoopback, noexcept, const char*, const std::nothrow_t&)
+Device DeviceManagerImpl::openLoopback(const char *name, const std::nothrow_t&) noexcept
+{
+    try {
+        return openLoopback(name);
+    }
+    catch(...) {
+    }
+    return Device();
+}
+
 void DeviceManagerImpl::removeDevice(DeviceImpl *dev)
 {
     auto iter = std::find_if(mDevices.begin(), mDevices.end(),
@@ -10,6 +10,9 @@ class DeviceManagerImpl {
 
     Vector<UniquePtr<DeviceImpl>> mDevices;
 
+    LPALCLOOPBACKOPENDEVICESOFT alcLoopbackOpenDeviceSOFT{nullptr};
+    LPALCRENDERSAMPLESSOFT alcRenderSamplesSOFT{nullptr};
+
 public:
     static ALCboolean (ALC_APIENTRY*SetThreadContext)(ALCcontext*);
 
@@ -27,6 +30,9 @@ public:
 
     Device openPlayback(const char *name);
     Device openPlayback(const char *name, const std::nothrow_t&) noexcept;
+
+    Device openLoopback(const char *name);
+    Device openLoopback(const char *name, const std::nothrow_t&) noexcept;
 };
 
 } // namespace alure
@@ -199,7 +199,7 @@ public:
 
 
 SourceImpl::SourceImpl(ContextImpl &context)
-  : mContext(context), mId(0), mBuffer(0), mGroup(nullptr), mIsAsync(false)
+  : mContext(context), mId(0), mBuffer(0), mGroup(nullptr), mIsAsync(false), mUnderruns(0)
   , mDirectFilter(AL_FILTER_NULL)
 {
     resetProperties();
@@ -425,6 +425,7 @@ void SourceImpl::play(SharedPtr<Decoder>&& decoder, ALsizei chunk_len, ALsizei q
     mBuffer = 0;
 
     mStream = std::move(stream);
+    mUnderruns.store(0, std::memory_order_relaxed);
 
     mStream->seek(mOffset);
     mOffset = 0;
@@ -775,7 +776,12 @@ bool SourceImpl::updateAsync()
     {
         // Make sure the source is still playing if it's not paused.
         if(state != AL_PLAYING)
+        {
+            // It played all the queued buffers before the refill.
+            if(state == AL_STOPPED)
+                mUnderruns.fetch_add(1, std::memory_order_relaxed);
             alSourcePlay(mId);
+        }
     }
     else
     {
@@ -1502,6 +1508,7 @@ void SourceImpl::destroy()
 
 DECL_THUNK0(SourceGroup, Source, getGroup, const)
 DECL_THUNK0(ALuint, Source, getPriority, const)
+DECL_THUNK0(uint64_t, Source, getUnderrunCount, const)
 DECL_THUNK0(bool, Source, getLooping, const)
 DECL_THUNK0(ALfloat, Source, getPitch, const)
 DECL_THUNK0(ALfloat, Source, getGain, const)
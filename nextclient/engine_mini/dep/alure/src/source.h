@@ -59,6 +59,8 @@ class SourceImpl {
     std::atomic<bool> mIsAsync;
 
     std::atomic<bool> mPaused;
+    // times the stream ran out of queued buffers while playing
+    std::atomic<uint64_t> mUnderruns;
     uint64_t mOffset;
     ALfloat mPitch;
     ALfloat mGain;
@@ -133,6 +135,8 @@ public:
     void setPriority(ALuint priority);
     ALuint getPriority() const { return mPriority; }
 
+    uint64_t getUnderrunCount() const { return mUnderruns.load(std::memory_order_relaxed); }
+
     void setOffset(uint64_t offset);
     std::pair<uint64_t,std::chrono::nanoseconds> getSampleOffsetLatency() const;
     std::pair<Seconds,Seconds> getSecOffsetLatency() const;
@@ -1,6 +1,8 @@
 #pragma once
 #include <unordered_map>
 #include <sstream>
+#include <chrono>
+#include <optional>
 
 #include "snd_local.h"
 #include "alure2.h"
@@ -9,13 +11,15 @@
 #include "Utilities/AudioCache.hpp"
 #include "Loaders/SoundLoader.hpp"
 #include "Utilities/ChannelManager.hpp"
+#include "Utilities/SfxRegistry.hpp"
+#include "Utilities/SoundEventLog.hpp"
 
 namespace MetaAudio
 {
   class AudioEngine final
   {
   private:
-    std::unordered_map<alure::String, sfx_t> known_sfx;
+    SfxRegistry known_sfx;
 
     bool openal_started = false;
     bool openal_mute = false;
@@ -27,6 +31,17 @@ namespace MetaAudio
     alure::UniquePtr<VoxManager> vox{};
     alure::UniquePtr<ChannelManager> channel_manager{};
 
+    // the loopback device has no output, the mix is rendered on the game thread in S_Update
+    bool is_loopback = false;
+    alure::Vector<float> loopback_buffer{};
+    double loopback_pending_frames = 0;
+    double last_render_time = 0;
+
+    SoundEventLog event_log{};
+    std::chrono::steady_clock::time_point last_update_time{};
+    // the frame time of the replayed frame, used instead of the measured one
+    std::optional<float> replay_frame_time{};
+
     char al_device_name[1024] = "";
     int al_device_majorversion = 0;
     int al_device_minorversion = 0;
@@ -44,6 +59,9 @@ namespace MetaAudio
     void S_StartSound(int entnum, int entchannel, sfx_t* sfx, float* origin, float fvol, float attenuation, int flags, int pitch, bool is_static);
     void ConfigureSource(aud_channel_t* channel, aud_sfxcache_t* data);
 
+    float UpdateFrameTime();
+    void RenderLoopback(float frame_time);
+
     bool OpenAL_Init();
     void OpenAL_Shutdown();
 
@@ -55,6 +73,12 @@ namespace MetaAudio
     void AL_Version();
     void AL_ResetEFX();
     void AL_Devices(bool basic);
+    void AL_MemoryReport();
+    void AL_VoxBenchmark(int iterations);
+    // Starts recording the sound events to the file in the game directory, or stops if the name is empty
+    void AL_RecordEvents(const char* file_name);
+    // Replays the recorded events as fast as possible and prints the cost of the frames
+    void AL_ReplayEvents(const char* file_name);
 
     void SNDDMA_Init();
     void S_Init();
@@ -67,5 +91,7 @@ namespace MetaAudio
     void S_Update(float* origin, float* forward, float* right, float* up);
 
     sfx_t* S_FindName(const char* name, int* pfInCache);
+    // Frees the sounds which weren't used since the last map change
+    void S_EvictStaleSounds();
   };
 }
\ No newline at end of file
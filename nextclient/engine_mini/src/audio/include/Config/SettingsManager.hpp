@@ -15,6 +15,8 @@ namespace MetaAudio
 
         bool OcclusionEnabled();
         bool OcclusionFade();
+        float OcclusionRefreshInterval();
+        size_t OcclusionTraceBudget();
 
         bool ReverbEnabled();
         size_t ReverbType();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Effects/IOcclusionCalculator.hpp"
+#include "Effects/OcclusionCache.hpp"
 #include "Utilities/Fade.hpp"
 #include "Workarounds/IWorkarounds.hpp"
 #include "efx-presets.h"
@@ -16,6 +17,9 @@ namespace MetaAudio
       alure::AuxiliaryEffectSlot slot;
       alure::Effect effect;
       GainFading gain;
+      // the gain last set on the slot, and whether the effect properties changed since they were applied
+      float applied_gain = 0.0f;
+      bool is_effect_dirty = true;
       effectSlot(alure::AuxiliaryEffectSlot _slot, alure::Effect _effect)
       {
         slot = _slot;
@@ -24,6 +28,24 @@ namespace MetaAudio
     };
 
     alure::Vector<effectSlot> alAuxEffectSlots;
+    // the preset applied to the only slot when there is no second one to crossfade
+    int applied_preset = -1;
+
+    // The state shared by the channels, computed once per frame
+    struct FrameState
+    {
+      bool occlusion_enabled = false;
+      bool occlusion_fade = false;
+    } frame;
+
+    struct EffectCalls
+    {
+      uint32_t issued = 0;
+      uint32_t skipped = 0;
+    };
+    EffectCalls frame_calls;
+    EffectCalls last_frame_calls;
+    void CountCall(bool issued);
 
     // Default effects
     alure::Array<EFXEAXREVERBPROPERTIES, CSXROOM> presets_room =
@@ -72,6 +94,7 @@ namespace MetaAudio
     // For occlusion
     std::pair<alure::Vector3, alure::Vector3> listener_orientation;
     std::shared_ptr<IOcclusionCalculator> occlusion_calculator;
+    OcclusionCache occlusion_cache;
     std::unique_ptr<Fade> fader;
     std::unique_ptr<IWorkarounds> workarounds;
     void FadeToNewValue(const bool fade_enabled, const bool force_final, GainFading& value);
@@ -83,8 +106,14 @@ namespace MetaAudio
     EnvEffects(alure::Context& al_context, ALCuint max_sends, std::shared_ptr<IOcclusionCalculator> occlusion_calculator);
     ~EnvEffects();
 
+    // Called once per frame before the room effect is interpolated and the effects of the channels are applied
+    void BeginFrame();
     void InterplEffect(int roomtype);
     void ApplyEffect(aud_channel_t* ch, qboolean underwater);
     void SetListenerOrientation(std::pair<alure::Vector3, alure::Vector3> listenerOrientation);
+
+    // The effect parameter updates issued to OpenAL and skipped as unchanged in the last frame
+    uint32_t GetIssuedCalls() const { return last_frame_calls.issued; }
+    uint32_t GetSkippedCalls() const { return last_frame_calls.skipped; }
   };
 }
\ No newline at end of file
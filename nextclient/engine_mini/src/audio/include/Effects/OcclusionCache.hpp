@@ -0,0 +1,105 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+
+#include "IOcclusionCalculator.hpp"
+#include "Utilities/VectorUtils.hpp"
+
+namespace MetaAudio
+{
+  // Caches the occlusion of sound sources, so the traces of a source are repeated only when the refresh interval
+  // has passed or the source or the listener has moved to another grid cell. The refreshes are limited by
+  // a per-frame budget which is spread across the sources round-robin, the sources out of budget keep their last value.
+  // A source which moved to another cell out of budget takes the last value of its entity until its turn comes.
+  class OcclusionCache final
+  {
+  private:
+    // positions are compared on a grid of 8 units
+    static constexpr float GRID_SIZE = 8.0f * AL_UnitToMeters;
+    // entries not requested for this long are dropped
+    static constexpr double ENTRY_LIFETIME = 2.0;
+
+    struct GridPosition
+    {
+      int x;
+      int y;
+      int z;
+
+      bool operator==(const GridPosition& other) const = default;
+    };
+
+    // the attenuation scales the transmission through the obstacles, so the channels of
+    // an entity with different attenuations are cached separately
+    struct Key
+    {
+      int entnum;
+      GridPosition source;
+      float attenuation;
+
+      bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash
+    {
+      size_t operator()(const Key& key) const;
+    };
+
+    struct EntityKey
+    {
+      int entnum;
+      float attenuation;
+
+      bool operator==(const EntityKey& other) const = default;
+    };
+
+    struct EntityKeyHash
+    {
+      size_t operator()(const EntityKey& key) const;
+    };
+
+    struct Entry
+    {
+      GridPosition listener;
+      OcclusionFrequencyGain gain;
+      double update_time;
+      double last_used_time;
+    };
+
+    std::shared_ptr<IOcclusionCalculator> m_calculator;
+    std::unordered_map<Key, Entry, KeyHash> m_entries;
+    // the most recently calculated entry of each entity
+    std::unordered_map<EntityKey, Key, EntityKeyHash> m_latest_keys;
+
+    double m_time = 0;
+    double m_refresh_interval = 0;
+    size_t m_trace_budget = 0;
+    double m_last_prune_time = 0;
+
+    // round-robin state, the requests of a frame are numbered in the order they are made
+    size_t m_request_index = 0;
+    size_t m_requests_last_frame = 0;
+    size_t m_round_robin_offset = 0;
+
+    size_t m_calculations = 0;
+
+    static GridPosition ToGrid(const Vector3& position);
+    bool IsInBudget(size_t request_index) const;
+
+  public:
+    explicit OcclusionCache(std::shared_ptr<IOcclusionCalculator> calculator);
+
+    // trace_budget is the number of occlusion calculations per frame, 0 means unlimited
+    void BeginFrame(double time, double refresh_interval, size_t trace_budget);
+
+    OcclusionFrequencyGain GetParameters(int entnum,
+      Vector3 listenerPosition,
+      Vector3 listenerAhead,
+      Vector3 listenerUp,
+      Vector3 audioSourcePosition,
+      float sourceRadius,
+      float attenuationMultiplier);
+
+    void Clear();
+  };
+}
@@ -7,5 +7,8 @@ namespace MetaAudio
   {
   public:
     alure::UniquePtr<std::istream> openFile(const alure::String& name) noexcept override;
+
+    // Returns the filesystem path of the sound or an empty string if it doesn't exist
+    static alure::String FindFile(const alure::String& name);
   };
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "snd_local.h"
+#include "Utilities/SoundEnvelope.hpp"
 
 namespace MetaAudio
 {
@@ -8,16 +9,21 @@ namespace MetaAudio
   {
   public:
     static const alure::Array<alure::String, 4> SupportedExtensions;
-    bool GetWavinfo(wavinfo_t& info, alure::String full_path, alure::Vector<ALubyte>& data_output);
+    bool GetWavinfo(wavinfo_t& info, alure::String full_path, SoundEnvelope& envelope_output);
+    // Moves the format and the envelope collected while the buffer was loading, the loop points are left unset
+    void TakeBufferInfo(wavinfo_t& info, const alure::String& full_path, SoundEnvelope& envelope_output);
+    // Set before a buffer is loaded, the quiet samples are built only for the sentence words
+    void SetQuietSamplesNeeded(bool is_needed) { m_is_quiet_samples_needed = is_needed; }
     void bufferLoading(alure::StringView name, alure::ChannelConfig channels, alure::SampleType type, ALuint samplerate, alure::ArrayView<ALbyte> data) noexcept override;
 
   private:
     struct Audio
     {
       wavinfo_t info{};
-      alure::Vector<ALubyte> data;
+      SoundEnvelope envelope;
     };
 
     std::unordered_map<alure::String, Audio> m_data;
+    bool m_is_quiet_samples_needed = false;
   };
 }
\ No newline at end of file
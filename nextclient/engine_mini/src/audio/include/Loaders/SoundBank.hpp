@@ -0,0 +1,37 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+
+#include "alure2.h"
+#include "Loaders/SoundBankFormat.hpp"
+
+class MappedFile;
+
+namespace MetaAudio
+{
+  // Read-only view of a memory-mapped sound bank, built by the soundbank_builder tool from a game directory.
+  // An entry is used only while the source file in that directory is the one the entry was built from.
+  class SoundBank final
+  {
+  private:
+    std::shared_ptr<MappedFile> m_file;
+    // the directory the names of the entries are relative to
+    std::filesystem::path m_root;
+    std::unordered_map<std::string_view, const SoundBankEntry*> m_entries;
+
+    SoundBank() = default;
+
+  public:
+    // Returns nullptr if the bank doesn't exist or is malformed
+    static std::unique_ptr<SoundBank> Open(const std::filesystem::path& path);
+
+    // Returns the entry of the game path if the local file it resolves to is in the root of the bank and isn't changed
+    const SoundBankEntry* Find(std::string_view game_path, const char* local_path) const;
+    // The decoder reads the mapped PCM of the entry and keeps the bank file mapped while it's alive
+    alure::SharedPtr<alure::Decoder> CreateDecoder(const SoundBankEntry& entry) const;
+
+    size_t Size() const { return m_entries.size(); }
+  };
+}
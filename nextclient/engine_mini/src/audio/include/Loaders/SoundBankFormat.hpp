@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of the packed sound banks, shared by the engine and the soundbank_builder tool.
+// A bank holds the header, the entries, the names and the decoded PCM of the sounds.
+// The offsets are from the beginning of the file and the values are little-endian.
+namespace MetaAudio
+{
+  static constexpr char SOUND_BANK_FILE_NAME[] = "sound.nsb";
+
+  struct SoundBankHeader
+  {
+    static constexpr char MAGIC[4] = { 'N', 'S', 'B', 'K' };
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[4];
+    uint32_t version;
+    uint32_t entries_count;
+    uint32_t reserved;
+    uint64_t entries_offset;
+  };
+
+  enum class SoundBankSampleType : uint32_t
+  {
+    UInt8 = 0,
+    Int16 = 1
+  };
+
+  struct SoundBankEntry
+  {
+    // game path of the source file, lowercase with forward slashes: sound/weapons/ak47-1.wav
+    uint64_t name_offset;
+    uint32_t name_length;
+    uint32_t channels;
+    uint32_t sample_type;
+    uint32_t samplerate;
+    uint64_t frames;
+    uint32_t has_loop_points;
+    uint32_t reserved;
+    uint64_t loop_start;
+    uint64_t loop_end;
+    // the entry is stale when the size or the modification time of the source file has changed
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint64_t data_offset;
+    uint64_t data_size;
+  };
+
+  static_assert(sizeof(SoundBankHeader) == 24);
+  static_assert(sizeof(SoundBankEntry) == 88);
+}
@@ -1,8 +1,10 @@
 #pragma once
 #include <optional>
+#include <unordered_map>
 
 #include "alure2.h"
 #include "LocalAudioDecoder.hpp"
+#include "SoundBank.hpp"
 #include "../Utilities/AudioCache.hpp"
 
 namespace MetaAudio
@@ -13,11 +15,25 @@ namespace MetaAudio
     std::shared_ptr<AudioCache> m_cache;
     std::shared_ptr<LocalAudioDecoder> m_decoder;
 
-    // Check if file exists. Order: original, .wav, .flac, .ogg, .mp3
+    // sound name -> resolved file name, nullopt if no file is found for any of the extensions.
+    // Cleared on map change and when a sound is downloaded.
+    std::unordered_map<alure::String, std::optional<alure::String>> m_resolved_paths;
+    int m_resolved_paths_servercount = -1;
+
+    // banks of the game and the downloads directories, opened again on map change
+    alure::Vector<std::unique_ptr<SoundBank>> m_banks;
+    int m_banks_servercount = -1;
+
+    // Check if file exists. Order: .wav, .flac, .ogg, .mp3
     std::optional<alure::String> S_GetFilePath(const alure::String& sfx_name, bool is_stream);
+    std::optional<alure::String> S_ResolveFilePath(const alure::String& name, const alure::String& function_name);
     aud_sfxcache_t* S_LoadStreamSound(sfx_t* s, aud_channel_t* ch);
+    void S_OpenSoundBanks();
+    // Creates the buffer from the PCM in a sound bank, returns the loop points or nullopt if the file isn't in a bank
+    std::optional<wavinfo_t> S_LoadFromSoundBank(const alure::String& file_path, alure::Buffer& buffer);
   public:
     SoundLoader(const std::shared_ptr<AudioCache>& cache);
     aud_sfxcache_t* S_LoadSound(sfx_t* s, aud_channel_t* ch);
+    void InvalidateResolvedPaths();
   };
 }
\ No newline at end of file
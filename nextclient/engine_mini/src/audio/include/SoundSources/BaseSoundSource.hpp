@@ -1,4 +1,6 @@
 #pragma once
+#include <optional>
+
 #include "alure2.h"
 
 namespace MetaAudio
@@ -8,6 +10,13 @@ namespace MetaAudio
   protected:
     alure::AutoObj<alure::Source> m_source;
 
+  private:
+    // The effect parameters last passed to OpenAL. Each of them takes several AL calls,
+    // so they are only set again when the values change noticeably.
+    std::optional<alure::FilterParams> m_direct_filter;
+    std::optional<float> m_doppler_factor;
+    alure::Vector<std::optional<alure::FilterParams>> m_send_filters;
+
   public:
     ~BaseSoundSource();
 
@@ -33,11 +42,15 @@ namespace MetaAudio
 
     void Stop();
 
-    void SetDirectFilter(const alure::FilterParams& filter);
+    // The effect setters return false if the value is close to the applied one and no AL call was issued
+    bool SetDirectFilter(const alure::FilterParams& filter);
 
-    void SetDopplerFactor(float factor);
+    bool SetDopplerFactor(float factor);
 
-    void SetAuxiliarySendFilter(alure::AuxiliaryEffectSlot auxslot, ALuint send, const alure::FilterParams& filter);
+    bool SetAuxiliarySendFilter(alure::AuxiliaryEffectSlot auxslot, ALuint send, const alure::FilterParams& filter);
+
+    // Forgets the applied effect parameters, e.g. when the effect slots are recreated
+    void InvalidateEffects();
 
     void SetOffset(uint64_t offset);
 
@@ -48,5 +61,7 @@ namespace MetaAudio
     void SetAirAbsorptionFactor(float factor);
 
     uint64_t GetSampleOffset();
+
+    uint64_t GetUnderrunCount();
   };
 }
\ No newline at end of file
@@ -13,5 +13,6 @@ namespace MetaAudio
   public:
     aud_sfxcache_t* Cache_Alloc(cache_user_t* c, const alure::String& name);
     void Cache_Free(const alure::String& name);
+    void PrintMemoryReport() const;
   };
 }
\ No newline at end of file
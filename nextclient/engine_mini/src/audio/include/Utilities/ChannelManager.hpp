@@ -2,6 +2,7 @@
 #include <memory>
 
 #include "snd_local.h"
+#include "Utilities/ChannelPool.hpp"
 
 namespace MetaAudio
 {
@@ -12,12 +13,14 @@ namespace MetaAudio
     friend AudioEngine;
 
   private:
+    static constexpr size_t MAX_CHANNELS_PER_POOL = 256;
+
     cvar_t* al_xfi_workaround;
 
     struct
     {
-      std::vector<aud_channel_t> static_;
-      std::vector<aud_channel_t> dynamic;
+      ChannelPool static_{ MAX_CHANNELS_PER_POOL };
+      ChannelPool dynamic{ MAX_CHANNELS_PER_POOL };
     } channels;
 
     void FreeChannel(aud_channel_t* ch);
@@ -39,12 +42,12 @@ namespace MetaAudio
     template<class Functor>
     void ForEachChannel(const Functor& lambda)
     {
-      for (auto& channel : channels.dynamic) lambda(channel);
-      for (auto& channel : channels.static_) lambda(channel);
+      channels.dynamic.ForEach(lambda);
+      channels.static_.ForEach(lambda);
     }
 
     // delete copy
     ChannelManager(const ChannelManager& other) = delete;
     ChannelManager& operator=(const ChannelManager& other) = delete;
   };
-}
\ No newline at end of file
+}
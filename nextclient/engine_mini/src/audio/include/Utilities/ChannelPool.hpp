@@ -0,0 +1,71 @@
+#pragma once
+#include <optional>
+#include <unordered_map>
+
+#include "snd_local.h"
+
+namespace MetaAudio
+{
+  // Fixed-capacity storage of channels. A channel keeps its slot until it's freed,
+  // so freeing doesn't move the other channels and the pointers to them stay valid.
+  class ChannelPool final
+  {
+  private:
+    alure::Vector<aud_channel_t> m_slots;
+    alure::Vector<size_t> m_free_slots;
+    // slots of the playing channels, in no particular order
+    alure::Vector<size_t> m_active_slots;
+    // position of each slot in m_active_slots
+    alure::Vector<size_t> m_active_positions;
+    // entnum -> slots of the entity in allocation order
+    std::unordered_map<int, alure::Vector<size_t>> m_entity_slots;
+
+  public:
+    explicit ChannelPool(size_t capacity);
+
+    aud_channel_t* Allocate(int entnum, int entchannel);
+    // Allocates a channel for a static sound, a channel without a sound is reused first,
+    // the channel of the entity playing the same sound is replaced
+    aud_channel_t* AllocateStatic(int entnum, int entchannel, sfx_t* sfx);
+    void Free(size_t slot);
+    void Clear();
+
+    bool Contains(const aud_channel_t* ch) const;
+    size_t GetSlot(const aud_channel_t* ch) const { return static_cast<size_t>(ch - m_slots.data()); }
+
+    // Returns the slots of the entity's channels, the order is kept while the channels are freed
+    const alure::Vector<size_t>* GetEntitySlots(int entnum) const;
+    aud_channel_t& operator[](size_t slot) { return m_slots[slot]; }
+
+    template<class Functor>
+    void ForEach(const Functor& lambda)
+    {
+      for (size_t slot : m_active_slots) lambda(m_slots[slot]);
+    }
+
+    // Returns the slot of the first channel for which the predicate returns true
+    template<class Predicate>
+    std::optional<size_t> FindIf(const Predicate& predicate)
+    {
+      for (size_t slot : m_active_slots)
+      {
+        if (predicate(m_slots[slot]))
+          return slot;
+      }
+
+      return std::nullopt;
+    }
+
+    // Frees the channels for which the predicate returns true
+    template<class Predicate>
+    void FreeIf(const Predicate& predicate)
+    {
+      // backwards, since freeing moves the last active slot to the freed position
+      for (size_t i = m_active_slots.size(); i-- > 0;)
+      {
+        if (predicate(m_slots[m_active_slots[i]]))
+          Free(m_active_slots[i]);
+      }
+    }
+  };
+}
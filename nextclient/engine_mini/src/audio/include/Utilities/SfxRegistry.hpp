@@ -0,0 +1,58 @@
+#pragma once
+#include <string_view>
+#include <unordered_map>
+
+#include "snd_local.h"
+
+namespace MetaAudio
+{
+  // Storage of the known sounds. The sounds are allocated in fixed blocks, so a sfx_t keeps its address
+  // until it's removed, and the removed ones are reused from a free list. The names are indexed
+  // by views into sfx_t::name, so the lookups don't allocate.
+  class SfxRegistry final
+  {
+  private:
+    static constexpr size_t BLOCK_SIZE = 256;
+
+    alure::Vector<alure::UniquePtr<alure::Array<sfx_t, BLOCK_SIZE>>> m_blocks;
+    alure::Vector<sfx_t*> m_free;
+    std::unordered_map<std::string_view, sfx_t*> m_by_name;
+
+  public:
+    sfx_t* Find(std::string_view name) const;
+    // Adds a sound with the name and zeroed fields, the name must not be known yet
+    sfx_t* Add(std::string_view name);
+    void Remove(sfx_t* sfx);
+    void Clear();
+
+    size_t Size() const { return m_by_name.size(); }
+
+    template<class Functor>
+    void ForEach(const Functor& lambda)
+    {
+      for (auto& [name, sfx] : m_by_name) lambda(*sfx);
+    }
+
+    // Removes the sounds for which the predicate returns true, returns the number of removed sounds
+    template<class Predicate>
+    size_t RemoveIf(const Predicate& predicate)
+    {
+      size_t removed = 0;
+      for (auto it = m_by_name.begin(); it != m_by_name.end();)
+      {
+        sfx_t* sfx = it->second;
+        if (!predicate(*sfx))
+        {
+          ++it;
+          continue;
+        }
+
+        it = m_by_name.erase(it);
+        m_free.push_back(sfx);
+        ++removed;
+      }
+
+      return removed;
+    }
+  };
+}
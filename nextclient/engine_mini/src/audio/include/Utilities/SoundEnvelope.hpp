@@ -0,0 +1,32 @@
+#pragma once
+
+#include "alure2.h"
+
+namespace MetaAudio
+{
+  // Compact description of mono PCM data, built once when the sound is loaded so the PCM isn't kept for
+  // the mouth movement and the sentence word trimming.
+  class SoundEnvelope final
+  {
+  public:
+    static constexpr size_t WINDOW_SIZE = 80;
+
+  private:
+    // mean absolute amplitude (0 - 128) of each WINDOW_SIZE samples
+    alure::Vector<ALubyte> m_amplitudes;
+    // 1 bit per sample, set if the sample is near zero, only built for the sentence words
+    alure::Vector<ALubyte> m_quiet_samples;
+    size_t m_length = 0;
+
+  public:
+    // The quiet samples are used only to trim the sentence words at zero crossings
+    void Build(alure::ArrayView<ALbyte> data, alure::SampleType type, alure::ChannelConfig channels, bool with_quiet_samples);
+
+    bool empty() const { return m_amplitudes.empty(); }
+    size_t GetWindowsCount() const { return m_amplitudes.size(); }
+    ALubyte GetAmplitude(size_t window) const { return m_amplitudes[window]; }
+    // Always false if the quiet samples aren't built
+    bool IsQuiet(size_t sample) const;
+    size_t GetMemoryUsage() const;
+  };
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <fstream>
+#include <filesystem>
+
+#include "snd_local.h"
+
+namespace MetaAudio
+{
+  enum class SoundEventType
+  {
+    Frame,
+    Start,
+    StartStatic,
+    Stop,
+    StopAll
+  };
+
+  struct SoundEvent
+  {
+    SoundEventType type = SoundEventType::Frame;
+
+    // Frame: the time since the previous frame and the listener
+    float frame_time = 0;
+    vec3_t forward{};
+    vec3_t right{};
+    vec3_t up{};
+
+    // Start, StartStatic and Stop. The origin is also the listener position of a frame.
+    int entnum = 0;
+    int entchannel = 0;
+    vec3_t origin{};
+    float fvol = 0;
+    float attenuation = 0;
+    int flags = 0;
+    int pitch = 0;
+    alure::String name;
+
+    // StopAll
+    bool clear = false;
+  };
+
+  // Writes the calls of the sound API to a text file, one event per line, so a session
+  // can be replayed later through the same API to measure the cost of each frame.
+  class SoundEventLog final
+  {
+  private:
+    std::ofstream m_file;
+    size_t m_frames = 0;
+
+  public:
+    bool StartRecording(const std::filesystem::path& path);
+    // Returns the number of the recorded frames
+    size_t StopRecording();
+    bool IsRecording() const { return m_file.is_open(); }
+
+    void RecordFrame(float frame_time, const float* origin, const float* forward, const float* right, const float* up);
+    void RecordStart(bool is_static, int entnum, int entchannel, const sfx_t* sfx, const float* origin, float fvol, float attenuation, int flags, int pitch);
+    void RecordStop(int entnum, int entchannel);
+    void RecordStopAll(bool clear);
+
+    // Reads a recorded file, the malformed lines are skipped
+    static bool Load(const std::filesystem::path& path, alure::Vector<SoundEvent>& events);
+  };
+}
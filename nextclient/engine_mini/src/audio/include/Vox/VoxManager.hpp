@@ -1,6 +1,8 @@
 #pragma once
 
 #include <optional>
+#include <string_view>
+#include <unordered_map>
 
 #include "snd_local.h"
 #include "AudioEngine.hpp"
@@ -20,11 +22,30 @@ namespace MetaAudio
     alure::String voxcomma = "_comma";                        // vocal pause
     voxword_t voxwordDefault;
 
+    struct SentenceNameHash
+    {
+      size_t operator()(std::string_view name) const;
+    };
+
+    struct SentenceNameEqual
+    {
+      bool operator()(std::string_view a, std::string_view b) const;
+    };
+
+    // Sentence names of the engine table to their index, the names point into the table.
+    // The table is checked by its count and the first entry before use and indexed again if it has changed.
+    std::unordered_map<std::string_view, int, SentenceNameHash, SentenceNameEqual> m_sentence_index;
+    int m_indexed_sentences_count = -1;
+    const char* m_indexed_first_sentence = nullptr;
+
+    bool IsSentenceIndexValid() const;
+
     // Voice file lookup
     std::optional<alure::String> LookupString(const alure::String& pszin, int* psentencenum);
     alure::Vector<std::tuple<alure::StringView, alure::StringView>> GetDirectory(const alure::String& psz);
-    alure::Vector<alure::String> ParseString(const alure::StringView& psz);
-    std::optional<voxword_t> ParseWordParams(alure::String& psz, int fFirst);
+    // The words point into the string or into the pause names, they are valid while both are alive
+    alure::Vector<std::string_view> ParseString(std::string_view psz);
+    std::optional<voxword_t> ParseWordParams(std::string_view& psz, int fFirst);
 
     // Mouth movement
     void ForceInitMouth(int entnum);
@@ -36,6 +57,8 @@ namespace MetaAudio
     void TrimStartEndTimes(aud_channel_t* ch, aud_sfxcache_t* sc);
     void SetChanVolPitch(aud_channel_t* ch, float* fvol, float* fpitch);
     void ReadSentenceFile(void);
+    void IndexSentences();
+    void Benchmark(int iterations);
     aud_sfxcache_t* LoadSound(aud_channel_t* pchan, const alure::String& pszin);
     void MakeSingleWordSentence(aud_channel_t* ch, int pitch);
     void InitMouth(int entnum, int entchannel);
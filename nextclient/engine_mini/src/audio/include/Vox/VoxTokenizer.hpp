@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string_view>
+
+#include "alure2.h"
+
+namespace MetaAudio
+{
+  // Splits the string into:
+  // 1. Comma and periods
+  // 2. Words with parameters and just parameteres. For ex.: (p110 t40) clik!(p120)
+  // 3. Full words. For ex.: clik
+  // The words point into the string or into the pause names, they are valid while both are alive
+  alure::Vector<std::string_view> TokenizeVox(std::string_view psz, std::string_view comma, std::string_view period);
+}
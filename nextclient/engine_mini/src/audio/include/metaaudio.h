@@ -9,6 +9,11 @@ void AUDIO_Shutdown();
 void AUDIO_RegisterCommands();
 
 void S_UnloadSounds(const std::vector<std::string>& names);
+// Frees the sounds of the previous maps which weren't precached again, called after the precache
+void S_EvictStaleSounds();
+// Drops the resolved sound paths, so a downloaded sound replaces the cached lookup result.
+// filename is the game path of the file, not the path it's downloaded from
+void S_OnFileDownloaded(const char* filename);
 sfxcache_t* S_LoadSound(sfx_t* sound, channel_t* channel);
 void VoiceSE_NotifyFreeChannel(int channel);
 sentenceEntry_s* SequenceGetSentenceByIndex(unsigned int index);
\ No newline at end of file
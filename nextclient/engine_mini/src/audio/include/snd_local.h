@@ -2,6 +2,7 @@
 #include <queue>
 
 #include "sound_internal.h"
+#include "Utilities/SoundEnvelope.hpp"
 
 //internal structures
 
@@ -75,5 +76,6 @@ struct aud_sfxcache_t
   alure::SharedPtr<alure::Decoder> decoder;
   alure::Buffer buffer;
 
-  alure::Vector<ALubyte> data;
+  // for mouth movement and sentence trimming, empty for streams and non-mono sounds
+  MetaAudio::SoundEnvelope envelope;
 };
@@ -1,3 +1,7 @@
+#include <optick.h>
+#include <algorithm>
+#include <filesystem>
+
 #include "AudioEngine.hpp"
 
 #include "Utilities/VectorUtils.hpp"
@@ -14,6 +18,15 @@
 
 namespace MetaAudio
 {
+  // Alure refills the streams on its own thread, it wakes up this often instead of waiting for the next frame
+  static constexpr std::chrono::milliseconds STREAM_UPDATE_INTERVAL(10);
+
+  // the loopback device mixes to float stereo, at the rate of a common output device
+  static constexpr ALCint LOOPBACK_FREQUENCY = 44100;
+  static constexpr size_t LOOPBACK_CHANNELS = 2;
+  // a hitch doesn't render more than this at once
+  static constexpr float MAX_FRAME_TIME = 0.1f;
+
   AudioEngine::AudioEngine(std::shared_ptr<AudioCache> cache, std::shared_ptr<SoundLoader> loader) : m_cache(cache), m_loader(loader)
   {
   }
@@ -42,64 +55,57 @@ namespace MetaAudio
 
   void AudioEngine::S_FlushCaches()
   {
-    for (auto& sfx : known_sfx)
+    known_sfx.ForEach([&](sfx_t& sfx) { S_FreeCache(&sfx); });
+    known_sfx.Clear();
+  }
+
+  void AudioEngine::S_EvictStaleSounds()
+  {
+    OPTICK_EVENT();
+
+    size_t evicted = known_sfx.RemoveIf([&](sfx_t& sfx)
+      {
+        // servercount 0 marks the sounds which are kept for the whole session
+        if (sfx.servercount <= 0 || sfx.servercount == cl->servercount)
+          return false;
+
+        // the playing sounds are kept until the next map change
+        S_FreeCache(&sfx);
+        return sfx.cache.data == nullptr;
+      });
+
+    if (evicted > 0)
     {
-      S_FreeCache(&(sfx.second));
+      gEngfuncs.Con_DPrintf("S_EvictStaleSounds: %zu sounds freed, %zu known\n", evicted, known_sfx.Size());
     }
-    known_sfx.clear();
   }
 
   sfx_t* AudioEngine::S_FindName(const char* name, int* pfInCache)
   {
     try
     {
-      sfx_t* sfx = nullptr;
-
       if (!name)
         Sys_Error("S_FindName: NULL\n");
 
       if (strlen(name) >= MAX_QPATH)
         Sys_Error("Sound name too long: %s", name);
 
-      auto sfx_iterator = known_sfx.find(name);
-      if (sfx_iterator != known_sfx.end())
+      sfx_t* sfx = known_sfx.Find(name);
+      if (sfx)
       {
         if (pfInCache)
         {
-          *pfInCache = sfx_iterator->second.cache.data != nullptr ? 1 : 0;
+          *pfInCache = sfx->cache.data != nullptr ? 1 : 0;
         }
 
-        if (sfx_iterator->second.servercount > 0)
-          sfx_iterator->second.servercount = cl->servercount;
+        if (sfx->servercount > 0)
+          sfx->servercount = cl->servercount;
 
-        return &(sfx_iterator->second);
-      }
-      else
-      {
-        for (auto& sfxElement : known_sfx)
-        {
-          if (sfxElement.second.servercount > 0 && sfxElement.second.servercount != cl->servercount)
-          {
-            S_FreeCache(&(sfxElement.second));
-            known_sfx.erase(sfxElement.first);
-            break;
-          }
-        }
+        return sfx;
       }
 
-      if (!sfx)
-      {
-        auto result = known_sfx.emplace(name, sfx_t());
-        sfx = &(result.first->second);
-      }
-      else
-      {
-        //free OpenAL buffer and cache
-        S_FreeCache(sfx);
-      }
-
-      strncpy_s(sfx->name, name, sizeof(sfx->name) - 1);
-      sfx->name[sizeof(sfx->name) - 1] = 0;
+      // the stale sounds are evicted in bulk by S_EvictStaleSounds after the precache
+      sfx = known_sfx.Add(name);
 
       if (pfInCache)
         *pfInCache = 0;
@@ -207,7 +213,7 @@ namespace MetaAudio
     //move mouth
     if (ch->entnum > 0 && (ch->entchannel == CHAN_VOICE || ch->entchannel == CHAN_STREAM))
     {
-      if (sc && sc->channels == alure::ChannelConfig::Mono && !sc->data.empty())
+      if (sc && sc->channels == alure::ChannelConfig::Mono && !sc->envelope.empty())
       {
         vox->MoveMouth(ch, sc);
       }
@@ -293,7 +299,11 @@ namespace MetaAudio
     {
       vec_t orientation[6];
 
+      float frame_time = UpdateFrameTime();
+      event_log.RecordFrame(frame_time, origin, forward, right, up);
+
       // Update Alure's OpenAL context at the start of processing.
+      // The streams are refilled on Alure's thread, this only finishes the stopped and pending sources.
       al_context->update();
 
       channel_manager->ClearFinished();
@@ -360,6 +370,7 @@ namespace MetaAudio
       int roomtype = underwater ?
           (int)settings.ReverbUnderwaterType() :
           (int)settings.ReverbType();
+      al_efx->BeginFrame();
       al_efx->InterplEffect(roomtype);
 
       channel_manager->ForEachChannel([&](aud_channel_t& channel) { SND_Spatialize(&channel, false); });
@@ -368,21 +379,39 @@ namespace MetaAudio
       {
         std::string output;
         size_t total = 0;
+        uint64_t total_underruns = 0;
         channel_manager->ForEachChannel([&](aud_channel_t& channel)
           {
             if (channel.sfx && channel.volume > 0)
             {
-              output.append(std::to_string(static_cast<int>(channel.volume * 255.0f)) + " " + channel.sfx->name + "\n");
+              output.append(std::to_string(static_cast<int>(channel.volume * 255.0f)) + " " + channel.sfx->name);
+
+              uint64_t underruns = channel.sound_source ? channel.sound_source->GetUnderrunCount() : 0;
+              if (underruns > 0)
+              {
+                output.append(" (" + std::to_string(underruns) + " underruns)");
+                total_underruns += underruns;
+              }
+
+              output.append("\n");
               ++total;
             }
           });
 
         if (!output.empty())
         {
-          output.append("----(" + std::to_string(total) + ")----\n");
+          output.append("----(" + std::to_string(total) + ")----");
+          if (total_underruns > 0)
+          {
+            output.append("(" + std::to_string(total_underruns) + " underruns)----");
+          }
+          output.append("(efx " + std::to_string(al_efx->GetIssuedCalls()) + " set, " + std::to_string(al_efx->GetSkippedCalls()) + " skipped)----");
+          output.append("\n");
           gEngfuncs.Con_Printf(const_cast<char*>(output.c_str()));
         }
       }
+
+      RenderLoopback(frame_time);
     }
     catch (const std::exception& e)
     {
@@ -390,6 +419,41 @@ namespace MetaAudio
     }
   }
 
+  float AudioEngine::UpdateFrameTime()
+  {
+    auto now = std::chrono::steady_clock::now();
+    float frame_time = 0;
+    if (last_update_time != std::chrono::steady_clock::time_point{})
+    {
+      frame_time = std::min(std::chrono::duration<float>(now - last_update_time).count(), MAX_FRAME_TIME);
+    }
+    last_update_time = now;
+
+    return replay_frame_time.value_or(frame_time);
+  }
+
+  void AudioEngine::RenderLoopback(float frame_time)
+  {
+    last_render_time = 0;
+    if (!is_loopback)
+      return;
+
+    OPTICK_EVENT();
+
+    // the fractions of a sample frame are carried over, so the mix keeps up with the game time
+    loopback_pending_frames += static_cast<double>(frame_time) * LOOPBACK_FREQUENCY;
+    auto frames = static_cast<ALCsizei>(loopback_pending_frames);
+    loopback_pending_frames -= frames;
+    if (frames <= 0)
+      return;
+
+    loopback_buffer.resize(static_cast<size_t>(frames) * LOOPBACK_CHANNELS);
+
+    auto start_time = std::chrono::steady_clock::now();
+    al_device->renderSamples(loopback_buffer.data(), frames);
+    last_render_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  }
+
   void AudioEngine::ConfigureSource(aud_channel_t* channel, aud_sfxcache_t* audioData)
   {
     channel->sound_source->SetOffset(channel->start);
@@ -552,6 +616,7 @@ namespace MetaAudio
   {
     try
     {
+      event_log.RecordStart(false, entnum, entchannel, sfx, origin, fvol, attenuation, flags, pitch);
       S_StartSound(entnum, entchannel, sfx, origin, fvol, attenuation, flags, pitch, false);
     }
     catch (const std::exception& e)
@@ -564,6 +629,7 @@ namespace MetaAudio
   {
     try
     {
+      event_log.RecordStart(true, entnum, entchannel, sfx, origin, fvol, attenuation, flags, pitch);
       S_StartSound(entnum, entchannel, sfx, origin, fvol, attenuation, flags, pitch, true);
     }
     catch (const std::exception& e)
@@ -576,6 +642,7 @@ namespace MetaAudio
   {
     try
     {
+      event_log.RecordStop(entnum, entchannel);
       channel_manager->ClearEntityChannels(entnum, entchannel);
     }
     catch (const std::exception& e)
@@ -588,6 +655,8 @@ namespace MetaAudio
   {
     try
     {
+      event_log.RecordStopAll(clear);
+
       if (channel_manager != nullptr)
       {
         channel_manager->ClearAllChannels();
@@ -607,21 +676,45 @@ namespace MetaAudio
 
       al_dev_manager = alure::DeviceManager::getInstance();
 
-      char* _al_set_device;
-      gEngfuncs.CheckParm("-al_device", &_al_set_device);
+      // renders the mix without an audio device, e.g. to benchmark the replays on a headless machine
+      is_loopback = gEngfuncs.CheckParm("-al_loopback", nullptr) != 0;
 
-      if (_al_set_device != nullptr)
-        al_device = alure::MakeAuto(al_dev_manager.openPlayback(_al_set_device, std::nothrow));
-
-      if (!al_device)
+      if (is_loopback)
       {
-        auto default_device = al_dev_manager.defaultDeviceName(alure::DefaultDeviceType::Full);
-        al_device = alure::MakeAuto(al_dev_manager.openPlayback(default_device));
+        al_device = alure::MakeAuto(al_dev_manager.openLoopback());
+      }
+      else
+      {
+        char* _al_set_device;
+        gEngfuncs.CheckParm("-al_device", &_al_set_device);
+
+        if (_al_set_device != nullptr)
+          al_device = alure::MakeAuto(al_dev_manager.openPlayback(_al_set_device, std::nothrow));
+
+        if (!al_device)
+        {
+          auto default_device = al_dev_manager.defaultDeviceName(alure::DefaultDeviceType::Full);
+          al_device = alure::MakeAuto(al_dev_manager.openPlayback(default_device));
+        }
       }
 
       strncpy_s(al_device_name, al_device->getName().c_str(), sizeof(al_device_name));
 
-      al_context = alure::MakeAuto(al_device->createContext());
+      if (is_loopback)
+      {
+        alure::AttributePair attributes[] = {
+          { ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT },
+          { ALC_FORMAT_TYPE_SOFT, ALC_FLOAT_SOFT },
+          { ALC_FREQUENCY, LOOPBACK_FREQUENCY },
+          { ALC_HRTF_SOFT, ALC_FALSE },
+          alure::AttributesEnd()
+        };
+        al_context = alure::MakeAuto(al_device->createContext(attributes));
+      }
+      else
+      {
+        al_context = alure::MakeAuto(al_device->createContext());
+      }
 
       alure::Version ver = al_device->getALCVersion();
       al_device_majorversion = ver.getMajor();
@@ -629,6 +722,7 @@ namespace MetaAudio
 
       alure::Context::MakeCurrent(al_context->getHandle());
       al_context->setDistanceModel(alure::DistanceModel::Linear);
+      al_context->setAsyncWakeInterval(STREAM_UPDATE_INTERVAL);
       return true;
     }
     catch (const std::exception& e)
@@ -675,6 +769,29 @@ namespace MetaAudio
   {
     al_efx.reset();
     al_efx = alure::MakeUnique<EnvEffects>(*al_context, al_device->getMaxAuxiliarySends(), GetOccluder());
+
+    // the sends of the playing sources point to the destroyed slots
+    if (channel_manager != nullptr)
+    {
+      channel_manager->ForEachChannel([](aud_channel_t& channel)
+        {
+          if (channel.sound_source)
+            channel.sound_source->InvalidateEffects();
+        });
+    }
+  }
+
+  void AudioEngine::AL_MemoryReport()
+  {
+    m_cache->PrintMemoryReport();
+  }
+
+  void AudioEngine::AL_VoxBenchmark(int iterations)
+  {
+    if (vox)
+    {
+      vox->Benchmark(iterations);
+    }
   }
 
   void AudioEngine::AL_Devices(bool basic)
@@ -707,6 +824,158 @@ namespace MetaAudio
 
     channel_manager = alure::MakeUnique<ChannelManager>();
     vox = alure::MakeUnique<VoxManager>(this, m_loader);
+    vox->IndexSentences();
+  }
+
+  static void PrintFrameCosts(const char* label, alure::Vector<double>& times)
+  {
+    if (times.empty())
+      return;
+
+    std::sort(times.begin(), times.end());
+
+    double total = 0;
+    for (double time : times)
+      total += time;
+
+    auto percentile = [&times](double fraction) { return times[static_cast<size_t>(fraction * (times.size() - 1))] * 1000.0; };
+
+    gEngfuncs.Con_Printf("%-8s avg %8.3f ms, p50 %8.3f ms, p99 %8.3f ms, max %8.3f ms\n", label,
+      total / times.size() * 1000.0, percentile(0.5), percentile(0.99), times.back() * 1000.0);
+  }
+
+  void AudioEngine::AL_RecordEvents(const char* file_name)
+  {
+    if (file_name == nullptr || file_name[0] == '\0')
+    {
+      if (event_log.IsRecording())
+      {
+        gEngfuncs.Con_Printf("Recorded %zu frames.\n", event_log.StopRecording());
+      }
+      else
+      {
+        gEngfuncs.Con_Printf("Usage: al_record_events <file>, without the file stops the recording.\n");
+      }
+      return;
+    }
+
+    auto path = std::filesystem::path(gEngfuncs.pfnGetGameDirectory()) / file_name;
+    if (!event_log.StartRecording(path))
+    {
+      gEngfuncs.Con_Printf("Unable to open %s.\n", path.generic_string().c_str());
+      return;
+    }
+
+    gEngfuncs.Con_Printf("Recording the sound events to %s.\n", path.generic_string().c_str());
+  }
+
+  void AudioEngine::AL_ReplayEvents(const char* file_name)
+  {
+    if (!openal_started || channel_manager == nullptr)
+    {
+      gEngfuncs.Con_Printf("Failed to initalize OpenAL device.\n");
+      return;
+    }
+
+    if (file_name == nullptr || file_name[0] == '\0')
+    {
+      gEngfuncs.Con_Printf("Usage: al_replay_events <file>\n");
+      return;
+    }
+
+    if (event_log.IsRecording())
+    {
+      gEngfuncs.Con_Printf("Stop the recording before the replay.\n");
+      return;
+    }
+
+    alure::Vector<SoundEvent> events;
+    auto path = std::filesystem::path(gEngfuncs.pfnGetGameDirectory()) / file_name;
+    if (!SoundEventLog::Load(path, events))
+    {
+      gEngfuncs.Con_Printf("Unable to read %s.\n", path.generic_string().c_str());
+      return;
+    }
+
+    S_StopAllSounds(true);
+
+    alure::Vector<double> update_times;
+    alure::Vector<double> render_times;
+    double replayed_time = 0;
+    size_t started_sounds = 0;
+    size_t missing_sounds = 0;
+
+    for (auto& event : events)
+    {
+      switch (event.type)
+      {
+      case SoundEventType::Frame:
+      {
+        replay_frame_time = event.frame_time;
+        replayed_time += event.frame_time;
+
+        auto start_time = std::chrono::steady_clock::now();
+        S_Update(event.origin, event.forward, event.right, event.up);
+        double update_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+        // the mixing is timed on its own, the rest of the update is the channel logic
+        update_times.push_back(update_time - last_render_time);
+        render_times.push_back(last_render_time);
+        break;
+      }
+      case SoundEventType::Start:
+      case SoundEventType::StartStatic:
+      {
+        sfx_t* sfx = S_FindName(event.name.c_str(), nullptr);
+        if (sfx == nullptr)
+        {
+          ++missing_sounds;
+          break;
+        }
+
+        if (event.type == SoundEventType::StartStatic)
+        {
+          S_StartStaticSound(event.entnum, event.entchannel, sfx, event.origin, event.fvol, event.attenuation, event.flags, event.pitch);
+        }
+        else
+        {
+          S_StartDynamicSound(event.entnum, event.entchannel, sfx, event.origin, event.fvol, event.attenuation, event.flags, event.pitch);
+        }
+        ++started_sounds;
+        break;
+      }
+      case SoundEventType::Stop:
+        S_StopSound(event.entnum, event.entchannel);
+        break;
+      case SoundEventType::StopAll:
+        S_StopAllSounds(event.clear);
+        break;
+      }
+    }
+
+    replay_frame_time.reset();
+    S_StopAllSounds(true);
+
+    gEngfuncs.Con_Printf("Replayed %zu frames (%.2f s), %zu sounds started, %zu not found.\n",
+      update_times.size(), replayed_time, started_sounds, missing_sounds);
+
+    double total_render_time = 0;
+    for (double time : render_times)
+      total_render_time += time;
+
+    PrintFrameCosts("update", update_times);
+    if (is_loopback)
+    {
+      PrintFrameCosts("mixing", render_times);
+      if (total_render_time > 0)
+      {
+        gEngfuncs.Con_Printf("Mixed %.2f s of audio %.1fx faster than real time.\n", replayed_time, replayed_time / total_render_time);
+      }
+    }
+    else
+    {
+      gEngfuncs.Con_Printf("The mixing runs on the device thread, start with -al_loopback to measure it.\n");
+    }
   }
 
   std::shared_ptr<IOcclusionCalculator> AudioEngine::GetOccluder()
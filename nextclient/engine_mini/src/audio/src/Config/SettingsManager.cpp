@@ -1,5 +1,6 @@
 #include "Config/SettingsManager.hpp"
 #include "../../engine.h"
+#include <algorithm>
 
 namespace MetaAudio
 {
@@ -15,12 +16,16 @@ namespace MetaAudio
     static cvar_t* al_doppler = nullptr;
     static cvar_t* al_occlusion = nullptr;
     static cvar_t* al_occlusion_fade = nullptr;
+    static cvar_t* al_occlusion_refresh = nullptr;
+    static cvar_t* al_occlusion_budget = nullptr;
     static cvar_t* al_xfi_workaround = nullptr;
 
     static constexpr char DEFAULT_XFI_WORKAROUND[] = "0"; // Disabled
     static constexpr char DEFAULT_OCCLUDER[] = "0"; // GoldSrc
     static constexpr char DEFAULT_OCCLUSION[] = "1";
     static constexpr char DEFAULT_OCCLUSION_FADE[] = "1";
+    static constexpr char DEFAULT_OCCLUSION_REFRESH[] = "0.1"; // Seconds
+    static constexpr char DEFAULT_OCCLUSION_BUDGET[] = "32"; // Calculations per frame, 0 is unlimited
     static constexpr char DEFAULT_DOPPLER_FACTOR[] = "0.3";
 
     void SettingsManager::Init(const cl_enginefunc_t& engFuncs)
@@ -29,6 +34,8 @@ namespace MetaAudio
         if (al_doppler == nullptr) al_doppler = engFuncs.pfnRegisterVariable("al_doppler", DEFAULT_DOPPLER_FACTOR, FCVAR_EXTDLL);
         if (al_occlusion == nullptr) al_occlusion = engFuncs.pfnRegisterVariable("al_occlusion", DEFAULT_OCCLUSION, FCVAR_EXTDLL);
         if (al_occlusion_fade == nullptr) al_occlusion_fade = engFuncs.pfnRegisterVariable("al_occlusion_fade", DEFAULT_OCCLUSION_FADE, FCVAR_EXTDLL);
+        if (al_occlusion_refresh == nullptr) al_occlusion_refresh = engFuncs.pfnRegisterVariable("al_occlusion_refresh", DEFAULT_OCCLUSION_REFRESH, FCVAR_EXTDLL);
+        if (al_occlusion_budget == nullptr) al_occlusion_budget = engFuncs.pfnRegisterVariable("al_occlusion_budget", DEFAULT_OCCLUSION_BUDGET, FCVAR_EXTDLL);
 
         if (!COM_CheckParm("-nosound"))
         {
@@ -95,4 +102,14 @@ namespace MetaAudio
     {
         return static_cast<bool>(al_occlusion_fade->value);
     }
+
+    float SettingsManager::OcclusionRefreshInterval()
+    {
+        return std::max(al_occlusion_refresh->value, 0.0f);
+    }
+
+    size_t SettingsManager::OcclusionTraceBudget()
+    {
+        return static_cast<size_t>(std::max(al_occlusion_budget->value, 0.0f));
+    }
 }
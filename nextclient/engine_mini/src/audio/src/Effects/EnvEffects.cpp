@@ -1,5 +1,7 @@
 #include <filesystem>
 #include <algorithm>
+#include <cmath>
+#include <optick.h>
 
 #include "../../engine.h"
 #include "../../common/filesystem.h"
@@ -24,6 +26,17 @@ namespace MetaAudio
   static constexpr float AL_UNDERWATER_LP_GAIN = 0.25f;
   static constexpr float AL_UNDERWATER_DOPPLER_FACTOR_RATIO = 343.3f / 1484.0f;
 
+  // the slot gain is set again only when it changes by more than this
+  static constexpr float AL_SLOT_GAIN_THRESHOLD = 0.001f;
+
+  void EnvEffects::CountCall(bool issued)
+  {
+    if (issued)
+      ++frame_calls.issued;
+    else
+      ++frame_calls.skipped;
+  }
+
   void EnvEffects::FadeToNewValue(const bool fade_enabled,
     const bool force_final,
     GainFading& value)
@@ -80,20 +93,55 @@ namespace MetaAudio
         FadeToNewValue(true, false, alAuxEffectSlots[effect_slot].gain);
 
         alAuxEffectSlots[effect_slot].effect.setReverbProperties(desired);
+        alAuxEffectSlots[effect_slot].is_effect_dirty = true;
       }
     }
     else if (alAuxEffectSlots.size() == 1)
     {
-      alAuxEffectSlots[0].effect.setReverbProperties(desired);
+      int preset = roomtype > 0 && roomtype < CSXROOM && settings.ReverbEnabled() ? roomtype : 0;
+      if (applied_preset != preset)
+      {
+        applied_preset = preset;
+        alAuxEffectSlots[0].effect.setReverbProperties(desired);
+        alAuxEffectSlots[0].is_effect_dirty = true;
+      }
     }
 
+    // uploading the effect reloads the reverb of the slot, it's done only when the properties change
     for (auto& effectSlot : alAuxEffectSlots)
     {
-      effectSlot.slot.setGain(effectSlot.gain.current);
-      effectSlot.slot.applyEffect(effectSlot.effect);
+      bool is_gain_changed = std::abs(effectSlot.gain.current - effectSlot.applied_gain) > AL_SLOT_GAIN_THRESHOLD;
+      if (is_gain_changed)
+      {
+        effectSlot.slot.setGain(effectSlot.gain.current);
+        effectSlot.applied_gain = effectSlot.gain.current;
+      }
+      CountCall(is_gain_changed);
+
+      CountCall(effectSlot.is_effect_dirty);
+      if (effectSlot.is_effect_dirty)
+      {
+        effectSlot.slot.applyEffect(effectSlot.effect);
+        effectSlot.is_effect_dirty = false;
+      }
     }
   }
 
+  void EnvEffects::BeginFrame()
+  {
+    OPTICK_TAG("efx calls issued", last_frame_calls.issued);
+    OPTICK_TAG("efx calls skipped", last_frame_calls.skipped);
+
+    last_frame_calls = frame_calls;
+    frame_calls = {};
+
+    // the cvars are read once instead of for every channel
+    frame.occlusion_enabled = settings.OcclusionEnabled();
+    frame.occlusion_fade = settings.OcclusionFade();
+
+    occlusion_cache.BeginFrame(cl->time, settings.OcclusionRefreshInterval(), settings.OcclusionTraceBudget());
+  }
+
   void EnvEffects::SetListenerOrientation(std::pair<alure::Vector3, alure::Vector3> listenerOrientation)
   {
     listener_orientation = listenerOrientation;
@@ -108,7 +156,7 @@ namespace MetaAudio
     if (ch->entnum != cl->viewentity && pent != nullptr && sent != nullptr)
     {
       // Detect collisions and reduce gain on occlusion
-      if (settings.OcclusionEnabled())
+      if (frame.occlusion_enabled)
       {
         // Check occlusion only on those entities that can be heard.
         float distance = alure::Vector3(ch->origin[0], ch->origin[1], ch->origin[2]).getDistanceSquared(
@@ -128,7 +176,8 @@ namespace MetaAudio
             return Vector3{ ret[0], ret[1], ret[2] };
           };
 
-          auto occlusion = occlusion_calculator->GetParameters(
+          auto occlusion = occlusion_cache.GetParameters(
+            ch->entnum,
             getVector(pent->origin),
             Vector3{ listener_orientation.first[0], listener_orientation.first[1], listener_orientation.first[2] },
             Vector3{ listener_orientation.second[0], listener_orientation.second[1], listener_orientation.second[2] },
@@ -149,9 +198,9 @@ namespace MetaAudio
         ch->HighGain.target = 1.0f;
       }
 
-      FadeToNewValue(settings.OcclusionFade(), ch->firstpass, ch->LowGain);
-      FadeToNewValue(settings.OcclusionFade(), ch->firstpass, ch->MidGain);
-      FadeToNewValue(settings.OcclusionFade(), ch->firstpass, ch->HighGain);
+      FadeToNewValue(frame.occlusion_fade, ch->firstpass, ch->LowGain);
+      FadeToNewValue(frame.occlusion_fade, ch->firstpass, ch->MidGain);
+      FadeToNewValue(frame.occlusion_fade, ch->firstpass, ch->HighGain);
 
       params.mGain = ch->MidGain.current;
       params.mGainHF = ch->HighGain.current;
@@ -165,22 +214,22 @@ namespace MetaAudio
     if (underwater)
     {
       params.mGainHF *= AL_UNDERWATER_LP_GAIN;
-      ch->sound_source->SetDirectFilter(params);
-      ch->sound_source->SetDopplerFactor(AL_UNDERWATER_DOPPLER_FACTOR_RATIO);
+      CountCall(ch->sound_source->SetDirectFilter(params));
+      CountCall(ch->sound_source->SetDopplerFactor(AL_UNDERWATER_DOPPLER_FACTOR_RATIO));
     }
     else
     {
-      ch->sound_source->SetDirectFilter(params);
-      ch->sound_source->SetDopplerFactor(1.0f);
+      CountCall(ch->sound_source->SetDirectFilter(params));
+      CountCall(ch->sound_source->SetDopplerFactor(1.0f));
     }
 
     for (size_t i = 0; i < alAuxEffectSlots.size(); ++i)
     {
-      ch->sound_source->SetAuxiliarySendFilter(alAuxEffectSlots[i].slot, i, params);
+      CountCall(ch->sound_source->SetAuxiliarySendFilter(alAuxEffectSlots[i].slot, i, params));
     }
   }
 
-  EnvEffects::EnvEffects(alure::Context& al_context, ALCuint max_sends, std::shared_ptr<IOcclusionCalculator> occlusion_calculator) : occlusion_calculator(occlusion_calculator)
+  EnvEffects::EnvEffects(alure::Context& al_context, ALCuint max_sends, std::shared_ptr<IOcclusionCalculator> occlusion_calculator) : occlusion_calculator(occlusion_calculator), occlusion_cache(occlusion_calculator)
   {
     char* _al_maxsends;
     gEngfuncs.CheckParm("-al_maxsends", &_al_maxsends);
@@ -211,6 +260,7 @@ namespace MetaAudio
     if (alAuxEffectSlots.size() > 0)
     {
       alAuxEffectSlots[0].slot.setGain(AL_REVERBMIX);
+      alAuxEffectSlots[0].applied_gain = AL_REVERBMIX;
       alAuxEffectSlots[0].gain.current = AL_REVERBMIX;
       alAuxEffectSlots[0].gain.initial_value = AL_REVERBMIX;
       alAuxEffectSlots[0].gain.last_target = AL_REVERBMIX;
@@ -0,0 +1,145 @@
+#include "Effects/OcclusionCache.hpp"
+
+#include <cmath>
+#include <optick.h>
+
+namespace MetaAudio
+{
+  size_t OcclusionCache::KeyHash::operator()(const Key& key) const
+  {
+    size_t hash = std::hash<int>()(key.entnum);
+    for (int value : { key.source.x, key.source.y, key.source.z })
+    {
+      hash ^= std::hash<int>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+
+    hash ^= std::hash<float>()(key.attenuation) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+
+    return hash;
+  }
+
+  size_t OcclusionCache::EntityKeyHash::operator()(const EntityKey& key) const
+  {
+    size_t hash = std::hash<int>()(key.entnum);
+    hash ^= std::hash<float>()(key.attenuation) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+
+    return hash;
+  }
+
+  OcclusionCache::OcclusionCache(std::shared_ptr<IOcclusionCalculator> calculator) : m_calculator(calculator)
+  {
+  }
+
+  OcclusionCache::GridPosition OcclusionCache::ToGrid(const Vector3& position)
+  {
+    return GridPosition{
+      static_cast<int>(std::floor(position.X / GRID_SIZE)),
+      static_cast<int>(std::floor(position.Y / GRID_SIZE)),
+      static_cast<int>(std::floor(position.Z / GRID_SIZE))
+    };
+  }
+
+  void OcclusionCache::BeginFrame(double time, double refresh_interval, size_t trace_budget)
+  {
+    OPTICK_EVENT();
+    OPTICK_TAG("occlusion calculations", static_cast<uint32_t>(m_calculations));
+    OPTICK_TAG("occlusion requests", static_cast<uint32_t>(m_request_index));
+
+    // the time goes backwards on a new map
+    if (time < m_time)
+    {
+      Clear();
+    }
+
+    m_time = time;
+    m_refresh_interval = refresh_interval;
+    m_trace_budget = trace_budget;
+
+    // the next frame starts where the budget of this one ended
+    m_requests_last_frame = m_request_index;
+    if (m_requests_last_frame > 0)
+    {
+      m_round_robin_offset = (m_round_robin_offset + m_trace_budget) % m_requests_last_frame;
+    }
+
+    m_request_index = 0;
+    m_calculations = 0;
+
+    if (m_time - m_last_prune_time > ENTRY_LIFETIME)
+    {
+      std::erase_if(m_entries, [&](const auto& item) { return m_time - item.second.last_used_time > ENTRY_LIFETIME; });
+      std::erase_if(m_latest_keys, [&](const auto& item) { return !m_entries.contains(item.second); });
+      m_last_prune_time = m_time;
+    }
+  }
+
+  bool OcclusionCache::IsInBudget(size_t request_index) const
+  {
+    if (m_trace_budget == 0 || m_requests_last_frame <= m_trace_budget)
+    {
+      return true;
+    }
+
+    size_t position = (request_index + m_requests_last_frame - m_round_robin_offset % m_requests_last_frame) % m_requests_last_frame;
+    return position < m_trace_budget && m_calculations < m_trace_budget;
+  }
+
+  OcclusionFrequencyGain OcclusionCache::GetParameters(int entnum,
+    Vector3 listenerPosition,
+    Vector3 listenerAhead,
+    Vector3 listenerUp,
+    Vector3 audioSourcePosition,
+    float sourceRadius,
+    float attenuationMultiplier)
+  {
+    size_t request_index = m_request_index++;
+
+    Key key{ entnum, ToGrid(audioSourcePosition), attenuationMultiplier };
+    auto listener = ToGrid(listenerPosition);
+
+    auto it = m_entries.find(key);
+    if (it != m_entries.end())
+    {
+      auto& entry = it->second;
+      entry.last_used_time = m_time;
+
+      bool is_fresh = entry.listener == listener && m_time - entry.update_time < m_refresh_interval;
+      if (is_fresh || !IsInBudget(request_index))
+      {
+        return entry.gain;
+      }
+    }
+    else if (!IsInBudget(request_index))
+    {
+      // a moving source enters a new cell every few frames, it waits for its turn like the others
+      auto latest_it = m_latest_keys.find(EntityKey{ entnum, attenuationMultiplier });
+      if (latest_it != m_latest_keys.end())
+      {
+        auto latest_entry_it = m_entries.find(latest_it->second);
+        if (latest_entry_it != m_entries.end())
+        {
+          latest_entry_it->second.last_used_time = m_time;
+          return latest_entry_it->second.gain;
+        }
+      }
+    }
+
+    // new entities are always calculated, their first value isn't faded in
+    OPTICK_EVENT("OcclusionCalculate");
+    m_calculations++;
+
+    auto gain = m_calculator->GetParameters(listenerPosition, listenerAhead, listenerUp, audioSourcePosition, sourceRadius, attenuationMultiplier);
+    m_entries.insert_or_assign(key, Entry{ listener, gain, m_time, m_time });
+    m_latest_keys.insert_or_assign(EntityKey{ entnum, attenuationMultiplier }, key);
+
+    return gain;
+  }
+
+  void OcclusionCache::Clear()
+  {
+    m_entries.clear();
+    m_latest_keys.clear();
+    m_time = 0;
+    m_last_prune_time = 0;
+  }
+}
@@ -6,7 +6,7 @@
 
 namespace MetaAudio
 {
-  alure::UniquePtr<std::istream> GoldSrcFileFactory::openFile(const alure::String& name) noexcept
+  alure::String GoldSrcFileFactory::FindFile(const alure::String& name)
   {
     alure::String namebuffer = "sound";
 
@@ -17,21 +17,32 @@ namespace MetaAudio
 
     namebuffer.append(name);
 
-    auto fileExists = FS_FileExists(namebuffer.c_str());
-    if (!fileExists)
+    if (FS_FileExists(namebuffer.c_str()))
     {
-      namebuffer.clear();
-      if (name[0] != '/')
-      {
-        namebuffer.append("/");
-      }
-      namebuffer.append(name);
+      return namebuffer;
+    }
+
+    namebuffer.clear();
+    if (name[0] != '/')
+    {
+      namebuffer.append("/");
+    }
+    namebuffer.append(name);
 
-      fileExists = FS_FileExists(namebuffer.c_str());
+    if (FS_FileExists(namebuffer.c_str()))
+    {
+      return namebuffer;
     }
 
+    return alure::String();
+  }
+
+  alure::UniquePtr<std::istream> GoldSrcFileFactory::openFile(const alure::String& name) noexcept
+  {
+    alure::String namebuffer = FindFile(name);
+
     alure::UniquePtr<std::istream> file;
-    if (fileExists)
+    if (!namebuffer.empty())
     {
       char final_file_path[260]; // MAX_PATH
       FS_GetLocalPath(namebuffer.c_str(), final_file_path, sizeof(final_file_path));
@@ -5,7 +5,7 @@ namespace MetaAudio
 {
   const alure::Array<alure::String, 4> LocalAudioDecoder::SupportedExtensions = { ".wav", ".flac", ".ogg", ".mp3" };
 
-  bool LocalAudioDecoder::GetWavinfo(wavinfo_t& info, alure::String full_path, alure::Vector<ALubyte>& data_output)
+  bool LocalAudioDecoder::GetWavinfo(wavinfo_t& info, alure::String full_path, SoundEnvelope& envelope_output)
   {
     auto context = alure::Context::GetCurrent();
     alure::SharedPtr<alure::Decoder> dec;
@@ -19,28 +19,34 @@ namespace MetaAudio
       return false;
     }
 
-    auto& audioData = m_data[full_path];
-    info = audioData.info;
+    TakeBufferInfo(info, full_path, envelope_output);
 
     auto loop_points = dec->getLoopPoints();
     info.looping = dec->hasLoopPoints();
     info.loopstart = loop_points.first;
     info.loopend = loop_points.second;
 
-    data_output.swap(audioData.data);
-    m_data.erase(full_path);
     return true;
   }
 
+  void LocalAudioDecoder::TakeBufferInfo(wavinfo_t& info, const alure::String& full_path, SoundEnvelope& envelope_output)
+  {
+    auto& audioData = m_data[full_path];
+    info = audioData.info;
+
+    envelope_output = std::move(audioData.envelope);
+    m_data.erase(full_path);
+  }
+
   void LocalAudioDecoder::bufferLoading(alure::StringView name, alure::ChannelConfig channels, alure::SampleType type, ALuint samplerate, alure::ArrayView<ALbyte> data) noexcept
   {
-    auto temp_view = data.reinterpret_as<ALubyte>();
+    // only the envelope is kept, the PCM itself lives in the OpenAL buffer
     Audio audio{};
-    audio.data = alure::Vector<ALubyte>(temp_view.begin(), temp_view.end());
+    audio.envelope.Build(data, type, channels, m_is_quiet_samples_needed);
     audio.info.channels = channels;
     audio.info.samplerate = samplerate;
     audio.info.stype = type;
-    audio.info.samples = audio.data.size() / alure::FramesToBytes(1, audio.info.channels, audio.info.stype);
-    m_data.emplace(alure::String(name.data()), audio);
+    audio.info.samples = data.size() / alure::FramesToBytes(1, audio.info.channels, audio.info.stype);
+    m_data.emplace(alure::String(name.data()), std::move(audio));
   }
 }
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "Loaders/SoundBank.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <string>
+
+#include "../../../utils/MappedFile.h"
+
+namespace MetaAudio
+{
+  class SoundBankDecoder final : public alure::Decoder
+  {
+  private:
+    std::shared_ptr<MappedFile> m_file;
+    const SoundBankEntry& m_entry;
+    const uint8_t* m_data;
+    uint64_t m_position = 0;
+
+  public:
+    SoundBankDecoder(const std::shared_ptr<MappedFile>& file, const SoundBankEntry& entry)
+      : m_file(file), m_entry(entry), m_data(file->data() + entry.data_offset)
+    {
+    }
+
+    ALuint getFrequency() const noexcept override
+    {
+      return m_entry.samplerate;
+    }
+
+    alure::ChannelConfig getChannelConfig() const noexcept override
+    {
+      return m_entry.channels == 2 ? alure::ChannelConfig::Stereo : alure::ChannelConfig::Mono;
+    }
+
+    alure::SampleType getSampleType() const noexcept override
+    {
+      return static_cast<SoundBankSampleType>(m_entry.sample_type) == SoundBankSampleType::Int16 ? alure::SampleType::Int16 : alure::SampleType::UInt8;
+    }
+
+    bool hasLoopPoints() const noexcept override
+    {
+      return m_entry.has_loop_points != 0;
+    }
+
+    std::pair<uint64_t, uint64_t> getLoopPoints() const noexcept override
+    {
+      return { m_entry.loop_start, m_entry.loop_end };
+    }
+
+    uint64_t getLength() const noexcept override
+    {
+      return m_entry.frames;
+    }
+
+    bool seek(uint64_t pos) noexcept override
+    {
+      if (pos > m_entry.frames)
+        return false;
+
+      m_position = pos;
+      return true;
+    }
+
+    ALuint read(ALvoid* ptr, ALuint count) noexcept override
+    {
+      auto frames = static_cast<ALuint>(std::min<uint64_t>(count, m_entry.frames - m_position));
+      auto frame_size = alure::FramesToBytes(1, getChannelConfig(), getSampleType());
+
+      std::memcpy(ptr, m_data + m_position * frame_size, static_cast<size_t>(frames) * frame_size);
+      m_position += frames;
+
+      return frames;
+    }
+  };
+
+  static std::string NormalizePath(std::string_view path)
+  {
+    std::string result(path);
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    std::replace(result.begin(), result.end(), '\\', '/');
+
+    return result;
+  }
+
+  static bool IsInFile(const MappedFile& file, uint64_t offset, uint64_t size)
+  {
+    return offset <= file.size() && size <= file.size() - offset;
+  }
+
+  static bool IsValidEntry(const MappedFile& file, const SoundBankEntry& entry)
+  {
+    if (entry.channels != 1 && entry.channels != 2)
+      return false;
+
+    uint64_t sample_size;
+    switch (static_cast<SoundBankSampleType>(entry.sample_type))
+    {
+    case SoundBankSampleType::UInt8: sample_size = 1; break;
+    case SoundBankSampleType::Int16: sample_size = 2; break;
+    default: return false;
+    }
+
+    return entry.samplerate > 0 &&
+      entry.name_length > 0 &&
+      IsInFile(file, entry.name_offset, entry.name_length) &&
+      IsInFile(file, entry.data_offset, entry.data_size) &&
+      entry.data_size / (sample_size * entry.channels) == entry.frames &&
+      entry.data_offset % sample_size == 0;
+  }
+
+  std::unique_ptr<SoundBank> SoundBank::Open(const std::filesystem::path& path)
+  {
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec))
+      return nullptr;
+
+    auto file = std::make_shared<MappedFile>(path);
+    if (!file->is_open() || file->size() < sizeof(SoundBankHeader))
+      return nullptr;
+
+    SoundBankHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if (std::memcmp(header.magic, SoundBankHeader::MAGIC, sizeof(header.magic)) != 0 || header.version != SoundBankHeader::VERSION)
+      return nullptr;
+
+    if (header.entries_offset % alignof(SoundBankEntry) != 0 ||
+        !IsInFile(*file, header.entries_offset, static_cast<uint64_t>(header.entries_count) * sizeof(SoundBankEntry)))
+      return nullptr;
+
+    auto bank = std::unique_ptr<SoundBank>(new SoundBank());
+    bank->m_root = std::filesystem::absolute(path, ec).parent_path().lexically_normal();
+
+    auto entries = reinterpret_cast<const SoundBankEntry*>(file->data() + header.entries_offset);
+    bank->m_entries.reserve(header.entries_count);
+
+    for (uint32_t i = 0; i < header.entries_count; ++i)
+    {
+      const auto& entry = entries[i];
+      if (!IsValidEntry(*file, entry))
+        continue;
+
+      auto name = std::string_view(reinterpret_cast<const char*>(file->data() + entry.name_offset), entry.name_length);
+      bank->m_entries.emplace(name, &entry);
+    }
+
+    bank->m_file = std::move(file);
+    return bank;
+  }
+
+  const SoundBankEntry* SoundBank::Find(std::string_view game_path, const char* local_path) const
+  {
+    auto it = m_entries.find(NormalizePath(game_path));
+    if (it == m_entries.end())
+      return nullptr;
+
+    // the file may be resolved to another search path which overrides the directory of the bank
+    std::error_code ec;
+    auto expected_path = (m_root / std::filesystem::path(it->first)).lexically_normal();
+    auto actual_path = std::filesystem::absolute(local_path, ec).lexically_normal();
+    if (ec || NormalizePath(expected_path.generic_string()) != NormalizePath(actual_path.generic_string()))
+      return nullptr;
+
+    std::filesystem::directory_entry file(actual_path, ec);
+    if (ec)
+      return nullptr;
+
+    auto size = file.file_size(ec);
+    if (ec)
+      return nullptr;
+
+    auto mtime = file.last_write_time(ec).time_since_epoch().count();
+    if (ec)
+      return nullptr;
+
+    const auto* entry = it->second;
+    if (entry->source_size != size || entry->source_mtime != static_cast<int64_t>(mtime))
+      return nullptr;
+
+    return entry;
+  }
+
+  alure::SharedPtr<alure::Decoder> SoundBank::CreateDecoder(const SoundBankEntry& entry) const
+  {
+    return alure::MakeShared<SoundBankDecoder>(m_file, entry);
+  }
+}
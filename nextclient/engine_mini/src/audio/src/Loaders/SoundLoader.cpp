@@ -3,7 +3,9 @@
 #include <optick.h>
 
 #include "Voice/VoiceDecoder.hpp"
+#include "Loaders/GoldSrcFileFactory.hpp"
 #include "../../engine.h"
+#include "../../../common/filesystem.h"
 #include "../../../common/sys_dll.h"
 
 namespace MetaAudio
@@ -27,44 +29,119 @@ namespace MetaAudio
     {
       m_function_name = "S_LoadSound";
     }
-    bool valid_file = false;
 
-    int char_index = new_name.rfind('.', new_name.length());
+    if (m_resolved_paths_servercount != cl->servercount)
+    {
+      m_resolved_paths.clear();
+      m_resolved_paths_servercount = cl->servercount;
+    }
 
-    if (char_index != new_name.npos)
+    auto it = m_resolved_paths.find(new_name);
+    if (it != m_resolved_paths.end())
     {
-      auto context = alure::Context::GetCurrent();
-      for (const alure::String& extension : MetaAudio::LocalAudioDecoder::SupportedExtensions)
-      {
-        new_name.replace(char_index, new_name.npos, extension);
-        try
-        {
-          auto dec = context.createDecoder(new_name);
-          valid_file = true;
-          break;
-        }
-        catch (const std::runtime_error& error)
-        {
-          gEngfuncs.Con_DPrintf("%s: Couldn't load %s. %s.\n", m_function_name.c_str(), new_name.c_str(), error.what());
-          valid_file = false;
-        }
-      }
+      return it->second;
     }
-    else
+
+    auto file_path = S_ResolveFilePath(new_name, m_function_name);
+    m_resolved_paths.emplace(new_name, file_path);
+
+    return file_path;
+  }
+
+  std::optional<alure::String> SoundLoader::S_ResolveFilePath(const alure::String& name, const alure::String& function_name)
+  {
+    OPTICK_EVENT();
+
+    int char_index = name.rfind('.', name.length());
+    if (char_index == name.npos)
     {
-      gEngfuncs.Con_DPrintf("%s: Couldn't load %s. Invalid file name.\n", m_function_name.c_str(), sfx_name.c_str());
-      return std::optional<alure::String>{};
+      gEngfuncs.Con_DPrintf("%s: Couldn't load %s. Invalid file name.\n", function_name.c_str(), name.c_str());
+      return std::nullopt;
     }
 
-    if (valid_file)
+    // only the existence is checked, creating a decoder for each candidate opens the file and throws on failure
+    alure::String new_name(name);
+    for (const alure::String& extension : MetaAudio::LocalAudioDecoder::SupportedExtensions)
     {
-      return new_name;
+      new_name.replace(char_index, new_name.npos, extension);
+      if (!GoldSrcFileFactory::FindFile(new_name).empty())
+      {
+        return new_name;
+      }
     }
-    else
+
+    gEngfuncs.Con_DPrintf("%s: Couldn't load %s.\n", function_name.c_str(), name.c_str());
+    return std::nullopt;
+  }
+
+  void SoundLoader::InvalidateResolvedPaths()
+  {
+    m_resolved_paths.clear();
+  }
+
+  void SoundLoader::S_OpenSoundBanks()
+  {
+    if (m_banks_servercount == cl->servercount)
+      return;
+
+    OPTICK_EVENT();
+
+    m_banks.clear();
+    m_banks_servercount = cl->servercount;
+
+    alure::String game_directory = gEngfuncs.pfnGetGameDirectory();
+    for (const auto& directory : { game_directory, game_directory + "_downloads" })
     {
-      gEngfuncs.Con_DPrintf("%s: Couldn't load %s.\n", m_function_name.c_str(), sfx_name.c_str());
+      auto bank_path = std::filesystem::path(directory) / SOUND_BANK_FILE_NAME;
+      if (auto bank = SoundBank::Open(bank_path))
+      {
+        gEngfuncs.Con_DPrintf("Sound bank %s: %zu sounds\n", bank_path.generic_string().c_str(), bank->Size());
+        m_banks.emplace_back(std::move(bank));
+      }
+    }
+  }
+
+  std::optional<wavinfo_t> SoundLoader::S_LoadFromSoundBank(const alure::String& file_path, alure::Buffer& buffer)
+  {
+    S_OpenSoundBanks();
+    if (m_banks.empty())
+      return std::nullopt;
+
+    auto game_path = GoldSrcFileFactory::FindFile(file_path);
+    if (game_path.empty())
       return std::nullopt;
+
+    char local_path[260]; // MAX_PATH
+    if (!FS_GetLocalPath(game_path.c_str(), local_path, sizeof(local_path)))
+      return std::nullopt;
+
+    for (const auto& bank : m_banks)
+    {
+      const auto* entry = bank->Find(game_path, local_path);
+      if (entry == nullptr)
+        continue;
+
+      auto context = alure::Context::GetCurrent();
+      try
+      {
+        buffer = context.findBuffer(file_path);
+        if (!buffer)
+          buffer = context.createBufferFrom(file_path, bank->CreateDecoder(*entry));
+      }
+      catch (const std::exception& error)
+      {
+        gEngfuncs.Con_DPrintf("S_LoadSound: %s: %s, loading it from the file.\n", file_path.c_str(), error.what());
+        return std::nullopt;
+      }
+
+      wavinfo_t info{};
+      info.looping = entry->has_loop_points != 0;
+      info.loopstart = entry->loop_start;
+      info.loopend = entry->loop_end;
+      return info;
     }
+
+    return std::nullopt;
   }
 
   aud_sfxcache_t* SoundLoader::S_LoadStreamSound(sfx_t* s, aud_channel_t* ch)
@@ -185,16 +262,24 @@ namespace MetaAudio
         return nullptr;
       }
 
+      // VOX trims the sentence words at zero crossings, other sounds don't need the quiet samples
+      m_decoder->SetQuietSamplesNeeded(ch != nullptr && !ch->words.empty());
+
+      // the sound banks hold the decoded PCM, the files are decoded only when they aren't in a bank or are changed
       alure::Buffer al_buffer;
-      try
+      auto bank_info = S_LoadFromSoundBank(file_path.value(), al_buffer);
+      if (!bank_info.has_value())
       {
-        al_buffer = context.getBuffer(file_path.value());
-      }
-      catch (const std::exception& error)
-      {
-        gEngfuncs.Con_DPrintf("S_LoadSound: %s: %s\n", file_path.value().c_str(), error.what());
-        sc = nullptr;
-        return nullptr;
+        try
+        {
+          al_buffer = context.getBuffer(file_path.value());
+        }
+        catch (const std::exception& error)
+        {
+          gEngfuncs.Con_DPrintf("S_LoadSound: %s: %s\n", file_path.value().c_str(), error.what());
+          sc = nullptr;
+          return nullptr;
+        }
       }
 
       sc = m_cache->Cache_Alloc(&s->cache, s->name);
@@ -202,8 +287,15 @@ namespace MetaAudio
         return nullptr;
 
       wavinfo_t info{};
-      //We can't interfere with Alure, so we need a copy of the data for mouth movement.
-      if (!m_decoder->GetWavinfo(info, file_path.value(), sc->data))
+      //We can't interfere with Alure, so the envelope for mouth movement is built while the buffer is loading.
+      if (bank_info.has_value())
+      {
+        m_decoder->TakeBufferInfo(info, file_path.value(), sc->envelope);
+        info.looping = bank_info->looping;
+        info.loopstart = bank_info->loopstart;
+        info.loopend = bank_info->loopend;
+      }
+      else if (!m_decoder->GetWavinfo(info, file_path.value(), sc->envelope))
         return nullptr;
 
       sc->buffer = al_buffer;
@@ -1,7 +1,20 @@
 #include "SoundSources/BaseSoundSource.hpp"
 
+#include <cmath>
+
 namespace MetaAudio
 {
+  // a gain difference below this is not audible, about -60 dB of the full volume
+  static constexpr float EFFECT_GAIN_THRESHOLD = 0.001f;
+
+  static bool IsFilterChanged(const std::optional<alure::FilterParams>& applied, const alure::FilterParams& filter)
+  {
+    return !applied ||
+      std::abs(applied->mGain - filter.mGain) > EFFECT_GAIN_THRESHOLD ||
+      std::abs(applied->mGainHF - filter.mGainHF) > EFFECT_GAIN_THRESHOLD ||
+      std::abs(applied->mGainLF - filter.mGainLF) > EFFECT_GAIN_THRESHOLD;
+  }
+
   BaseSoundSource::~BaseSoundSource()
   {
     if (m_source)
@@ -20,6 +33,11 @@ namespace MetaAudio
     return m_source->getSampleOffset();
   }
 
+  uint64_t BaseSoundSource::GetUnderrunCount()
+  {
+    return m_source->getUnderrunCount();
+  }
+
   void BaseSoundSource::SetPosition(alure::Vector3 position)
   {
     m_source->setPosition(position);
@@ -65,19 +83,44 @@ namespace MetaAudio
     m_source->stop();
   }
 
-  void BaseSoundSource::SetDirectFilter(const alure::FilterParams& filter)
+  bool BaseSoundSource::SetDirectFilter(const alure::FilterParams& filter)
   {
+    if (!IsFilterChanged(m_direct_filter, filter))
+      return false;
+
     m_source->setDirectFilter(filter);
+    m_direct_filter = filter;
+    return true;
   }
 
-  void BaseSoundSource::SetDopplerFactor(float factor)
+  bool BaseSoundSource::SetDopplerFactor(float factor)
   {
+    if (m_doppler_factor == factor)
+      return false;
+
     m_source->setDopplerFactor(factor);
+    m_doppler_factor = factor;
+    return true;
   }
 
-  void BaseSoundSource::SetAuxiliarySendFilter(alure::AuxiliaryEffectSlot auxslot, ALuint send, const alure::FilterParams& filter)
+  bool BaseSoundSource::SetAuxiliarySendFilter(alure::AuxiliaryEffectSlot auxslot, ALuint send, const alure::FilterParams& filter)
   {
+    if (send >= m_send_filters.size())
+      m_send_filters.resize(send + 1);
+
+    if (!IsFilterChanged(m_send_filters[send], filter))
+      return false;
+
     m_source->setAuxiliarySendFilter(auxslot, send, filter);
+    m_send_filters[send] = filter;
+    return true;
+  }
+
+  void BaseSoundSource::InvalidateEffects()
+  {
+    m_direct_filter.reset();
+    m_doppler_factor.reset();
+    m_send_filters.clear();
   }
 
   void BaseSoundSource::SetOffset(uint64_t offset)
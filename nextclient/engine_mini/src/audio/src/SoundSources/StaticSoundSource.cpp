@@ -6,7 +6,9 @@ namespace MetaAudio
 {
   StaticSoundSource::StaticSoundSource(const alure::Buffer& buffer, const alure::Source& source): m_buffer(buffer)
   {
-    al_xfi_workaround = &gEngfuncs.pfnGetCvarPointer("al_xfi_workaround")->value;
+    // looked up once, the cvar list is walked on every lookup and sources are created for every sound
+    static float* xfi_workaround_value = &gEngfuncs.pfnGetCvarPointer("al_xfi_workaround")->value;
+    al_xfi_workaround = xfi_workaround_value;
     m_source = alure::AutoObj(source);
     m_frequency = buffer.getFrequency();
     m_length = buffer.getLength();
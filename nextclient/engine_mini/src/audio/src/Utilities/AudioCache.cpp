@@ -1,5 +1,6 @@
 #include "Utilities/AudioCache.hpp"
 #include "../../common/sys_dll.h"
+#include "../../engine.h"
 
 namespace MetaAudio
 {
@@ -20,4 +21,29 @@ namespace MetaAudio
   {
     cache.erase(name);
   }
+
+  void AudioCache::PrintMemoryReport() const
+  {
+    size_t sounds = 0;
+    size_t buffer_bytes = 0;
+    size_t pcm_copy_bytes = 0;
+    size_t envelope_bytes = 0;
+
+    for (const auto& [name, sc] : cache)
+    {
+      if (!sc.buffer)
+        continue;
+
+      sounds++;
+      buffer_bytes += sc.buffer.getSize();
+      envelope_bytes += sc.envelope.GetMemoryUsage();
+
+      // the copy of the PCM that was kept for the mouth movement before the envelope
+      pcm_copy_bytes += static_cast<size_t>(sc.length) * alure::FramesToBytes(1, sc.channels, sc.stype);
+    }
+
+    gEngfuncs.Con_Printf("Cached sounds: %zu\n", sounds);
+    gEngfuncs.Con_Printf("OpenAL buffers: %.2f MB\n", buffer_bytes / (1024.0 * 1024.0));
+    gEngfuncs.Con_Printf("Mouth envelopes: %.2f MB (a PCM copy would take %.2f MB)\n", envelope_bytes / (1024.0 * 1024.0), pcm_copy_bytes / (1024.0 * 1024.0));
+  }
 }
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "Utilities/ChannelManager.hpp"
 #include "Vox/VoxManager.hpp"
 #include "SoundSources/BaseSoundSource.hpp"
@@ -12,47 +14,27 @@ namespace MetaAudio
 
   bool ChannelManager::IsPlaying(sfx_t* sfx)
   {
-    auto functor = [&](aud_channel_t& channel) { return channel.sfx == sfx && channel.sound_source->IsPlaying(); };
+    bool is_playing = false;
+    ForEachChannel([&](aud_channel_t& channel) { is_playing = is_playing || (channel.sfx == sfx && channel.sound_source->IsPlaying()); });
 
-    return std::any_of(channels.dynamic.begin(), channels.dynamic.end(), functor) ||
-           std::any_of(channels.static_.begin(), channels.static_.end(), functor);
+    return is_playing;
   }
 
   void ChannelManager::FreeChannel(aud_channel_t* ch)
   {
-    auto it = std::find_if(channels.static_.begin(), channels.static_.end(), [&](aud_channel_t& channel) { return &channel == ch; });
-    if (it != channels.static_.end())
+    if (channels.static_.Contains(ch))
     {
-      channels.static_.erase(it);
+      channels.static_.Free(channels.static_.GetSlot(ch));
     }
-    else
+    else if (channels.dynamic.Contains(ch))
     {
-      it = std::find_if(channels.dynamic.begin(), channels.dynamic.end(), [&](aud_channel_t& channel) { return &channel == ch; });
-      if (it != channels.dynamic.end())
-      {
-        channels.dynamic.erase(it);
-      }
+      channels.dynamic.Free(channels.dynamic.GetSlot(ch));
     }
   }
 
   aud_channel_t* ChannelManager::SND_PickStaticChannel(int entnum, int entchannel, sfx_t* sfx)
   {
-    // We do not want an entity playing the same SFX more than once.
-    auto channel = std::find_if(
-      channels.static_.begin(),
-      channels.static_.end(),
-      [&](aud_channel_t& channel)
-      {
-        return channel.sfx == nullptr ||
-          (channel.sfx == sfx && channel.entnum == entnum && (channel.entchannel == entchannel || entchannel == -1)); // actually should compare origin to be sure
-      }
-    );
-    if (channel != channels.static_.end())
-    {
-      channels.static_.erase(channel);
-    }
-
-    return &channels.static_.emplace_back();
+    return channels.static_.AllocateStatic(entnum, entchannel, sfx);
   }
 
   aud_channel_t* ChannelManager::SND_PickDynamicChannel(int entnum, int entchannel, sfx_t* sfx)
@@ -63,69 +45,69 @@ namespace MetaAudio
     }
 
     // Remove channel if entity is already using for vox. We do not want the entity talking about two things at the same time.
-    auto channel = std::find_if(
-      channels.dynamic.begin(),
-      channels.dynamic.end(),
-      [&](aud_channel_t& channel)
+    auto entity_slots = channels.dynamic.GetEntitySlots(entnum);
+    if (entchannel != CHAN_AUTO && entity_slots)
+    {
+      for (size_t slot : *entity_slots)
       {
+        auto& channel = channels.dynamic[slot];
+
         if (channel.sfx && channel.entchannel == CHAN_STREAM)
         {
-          return false;
+          continue;
         }
 
-        if (channel.sfx && channel.entnum == cl->viewentity && entnum != cl->viewentity)
+        if (channel.entchannel != entchannel && entchannel != -1)
         {
-          return false;
+          continue;
         }
 
-        if (entchannel != CHAN_AUTO && channel.entnum == entnum && (channel.entchannel == entchannel || entchannel == -1))
+        if (channel.sfx)
         {
-          return true;
-        }
-
-        return false;
-      });
-
-    if (channel != channels.dynamic.end())
-    {
-      if (channel->sfx)
-      {
-        auto sc = reinterpret_cast<aud_sfxcache_t*>(channel->sfx->cache.data);
-        if (sc && sc->looping)
-        {
-          if (channel->sfx == sfx && channel->entnum == entnum && channel->entchannel == entchannel)
+          auto sc = reinterpret_cast<aud_sfxcache_t*>(channel.sfx->cache.data);
+          if (sc && sc->looping)
           {
-            return nullptr;
+            if (channel.sfx == sfx && channel.entnum == entnum && channel.entchannel == entchannel)
+            {
+              return nullptr;
+            }
           }
         }
+
+        channels.dynamic.Free(slot);
+        break;
       }
+    }
 
-      channels.dynamic.erase(channel);
+    auto channel = channels.dynamic.Allocate(entnum, entchannel);
+    if (channel == nullptr)
+    {
+      gEngfuncs.Con_DPrintf("SND_PickDynamicChannel: all %zu channels are in use\n", MAX_CHANNELS_PER_POOL);
     }
 
-    return &channels.dynamic.emplace_back();
+    return channel;
   }
 
   void ChannelManager::ClearAllChannels()
   {
-    channels.dynamic.clear();
-    channels.static_.clear();
+    channels.dynamic.Clear();
+    channels.static_.Clear();
   }
 
   void ChannelManager::ClearEntityChannels(int entnum, int entchannel)
   {
     auto functor = [&](auto& channel) { return channel.entnum == entnum && channel.entchannel == entchannel; };
 
-    channels.dynamic.erase(std::remove_if(channels.dynamic.begin(), channels.dynamic.end(), functor), channels.dynamic.end());
-    channels.static_.erase(std::remove_if(channels.static_.begin(), channels.static_.end(), functor), channels.static_.end());
+    channels.dynamic.FreeIf(functor);
+    channels.static_.FreeIf(functor);
   }
 
   void ChannelManager::ClearFinished()
   {
     auto functor = [&](aud_channel_t& channel) { return channel.words.size() == 0 && !channel.sound_source->IsPlaying(); };
 
-    channels.dynamic.erase(std::remove_if(channels.dynamic.begin(), channels.dynamic.end(), functor), channels.dynamic.end());
-    channels.static_.erase(std::remove_if(channels.static_.begin(), channels.static_.end(), functor), channels.static_.end());
+    channels.dynamic.FreeIf(functor);
+    channels.static_.FreeIf(functor);
   }
 
   void ChannelManager::ClearLoopingRemovedEntities()
@@ -140,8 +122,8 @@ namespace MetaAudio
       return entity == nullptr;
     };
 
-    channels.dynamic.erase(std::remove_if(channels.dynamic.begin(), channels.dynamic.end(), functor), channels.dynamic.end());
-    channels.static_.erase(std::remove_if(channels.static_.begin(), channels.static_.end(), functor), channels.static_.end());
+    channels.dynamic.FreeIf(functor);
+    channels.static_.FreeIf(functor);
   }
 
   int ChannelManager::S_AlterChannel(int entnum, int entchannel, sfx_t* sfx, float fvol, float pitch, int flags)
@@ -209,7 +191,24 @@ namespace MetaAudio
       };
     }
 
-    return std::any_of(channels.dynamic.begin(), channels.dynamic.end(), functor) ||
-           std::any_of(channels.static_.begin(), channels.static_.end(), functor);
+    // only the channels of the entity can match
+    for (auto pool : { &channels.dynamic, &channels.static_ })
+    {
+      auto entity_slots = pool->GetEntitySlots(entnum);
+      if (!entity_slots)
+      {
+        continue;
+      }
+
+      for (size_t slot : *entity_slots)
+      {
+        if (functor((*pool)[slot]))
+        {
+          return true;
+        }
+      }
+    }
+
+    return false;
   }
 }
\ No newline at end of file
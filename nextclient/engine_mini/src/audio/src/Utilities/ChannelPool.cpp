@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <memory>
+
+#include "Utilities/ChannelPool.hpp"
+
+namespace MetaAudio
+{
+  ChannelPool::ChannelPool(size_t capacity)
+    : m_slots(capacity), m_active_positions(capacity)
+  {
+    m_free_slots.reserve(capacity);
+    m_active_slots.reserve(capacity);
+
+    // the lowest slots are allocated first
+    for (size_t slot = capacity; slot-- > 0;)
+    {
+      m_free_slots.push_back(slot);
+    }
+  }
+
+  aud_channel_t* ChannelPool::Allocate(int entnum, int entchannel)
+  {
+    if (m_free_slots.empty())
+    {
+      return nullptr;
+    }
+
+    size_t slot = m_free_slots.back();
+    m_free_slots.pop_back();
+
+    m_active_positions[slot] = m_active_slots.size();
+    m_active_slots.push_back(slot);
+    m_entity_slots[entnum].push_back(slot);
+
+    auto& channel = m_slots[slot];
+    channel.entnum = entnum;
+    channel.entchannel = entchannel;
+
+    return &channel;
+  }
+
+  void ChannelPool::Free(size_t slot)
+  {
+    size_t position = m_active_positions[slot];
+    size_t last_slot = m_active_slots.back();
+    m_active_slots[position] = last_slot;
+    m_active_positions[last_slot] = position;
+    m_active_slots.pop_back();
+
+    auto& channel = m_slots[slot];
+
+    auto entity_slots = m_entity_slots.find(channel.entnum);
+    if (entity_slots != m_entity_slots.end())
+    {
+      auto& slots = entity_slots->second;
+      slots.erase(std::find(slots.begin(), slots.end(), slot));
+      if (slots.empty())
+      {
+        m_entity_slots.erase(entity_slots);
+      }
+    }
+
+    // releases the sound source and closes the mouth like the removal from a vector did
+    std::destroy_at(&channel);
+    std::construct_at(&channel);
+
+    m_free_slots.push_back(slot);
+  }
+
+  void ChannelPool::Clear()
+  {
+    FreeIf([](aud_channel_t&) { return true; });
+  }
+
+  bool ChannelPool::Contains(const aud_channel_t* ch) const
+  {
+    return ch >= m_slots.data() && ch < m_slots.data() + m_slots.size();
+  }
+
+  const alure::Vector<size_t>* ChannelPool::GetEntitySlots(int entnum) const
+  {
+    auto it = m_entity_slots.find(entnum);
+    if (it == m_entity_slots.end())
+    {
+      return nullptr;
+    }
+
+    return &it->second;
+  }
+
+  aud_channel_t* ChannelPool::AllocateStatic(int entnum, int entchannel, sfx_t* sfx)
+  {
+    // a channel without a sound is reused first
+    auto empty_slot = FindIf([](aud_channel_t& channel) { return channel.sfx == nullptr; });
+    if (empty_slot)
+    {
+      Free(*empty_slot);
+      return Allocate(entnum, entchannel);
+    }
+
+    // We do not want an entity playing the same SFX more than once.
+    auto entity_slots = GetEntitySlots(entnum);
+    if (entity_slots)
+    {
+      for (size_t slot : *entity_slots)
+      {
+        auto& channel = m_slots[slot];
+        if (channel.sfx == sfx && (channel.entchannel == entchannel || entchannel == -1)) // actually should compare origin to be sure
+        {
+          Free(slot);
+          break;
+        }
+      }
+    }
+
+    return Allocate(entnum, entchannel);
+  }
+}
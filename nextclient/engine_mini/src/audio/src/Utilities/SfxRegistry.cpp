@@ -0,0 +1,48 @@
+#include "Utilities/SfxRegistry.hpp"
+
+#include <algorithm>
+
+namespace MetaAudio
+{
+  sfx_t* SfxRegistry::Find(std::string_view name) const
+  {
+    auto it = m_by_name.find(name);
+    return it != m_by_name.end() ? it->second : nullptr;
+  }
+
+  sfx_t* SfxRegistry::Add(std::string_view name)
+  {
+    if (m_free.empty())
+    {
+      auto& block = m_blocks.emplace_back(alure::MakeUnique<alure::Array<sfx_t, BLOCK_SIZE>>());
+
+      // the first slots of the block are popped first
+      for (size_t i = BLOCK_SIZE; i-- > 0;)
+        m_free.push_back(&(*block)[i]);
+    }
+
+    sfx_t* sfx = m_free.back();
+    m_free.pop_back();
+
+    *sfx = sfx_t{};
+    auto length = std::min(name.size(), sizeof(sfx->name) - 1);
+    std::copy_n(name.data(), length, sfx->name);
+    sfx->name[length] = 0;
+
+    m_by_name.emplace(std::string_view(sfx->name, length), sfx);
+    return sfx;
+  }
+
+  void SfxRegistry::Remove(sfx_t* sfx)
+  {
+    if (m_by_name.erase(std::string_view(sfx->name)) != 0)
+      m_free.push_back(sfx);
+  }
+
+  void SfxRegistry::Clear()
+  {
+    m_by_name.clear();
+    m_free.clear();
+    m_blocks.clear();
+  }
+}
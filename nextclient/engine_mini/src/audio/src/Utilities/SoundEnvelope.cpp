@@ -0,0 +1,99 @@
+#include "Utilities/SoundEnvelope.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+namespace MetaAudio
+{
+  template<class T, class ToSigned8, class IsQuiet>
+  static void BuildFromSamples(alure::ArrayView<T> samples, alure::Vector<ALubyte>& amplitudes, alure::Vector<ALubyte>& quiet_samples, bool with_quiet_samples, ToSigned8 to_signed8, IsQuiet is_quiet)
+  {
+    amplitudes.resize((samples.size() + SoundEnvelope::WINDOW_SIZE - 1) / SoundEnvelope::WINDOW_SIZE);
+    if (with_quiet_samples)
+    {
+      quiet_samples.resize((samples.size() + 7) / 8);
+    }
+
+    for (size_t window = 0; window < amplitudes.size(); ++window)
+    {
+      size_t start = window * SoundEnvelope::WINDOW_SIZE;
+      size_t end = std::min(start + SoundEnvelope::WINDOW_SIZE, samples.size());
+
+      int sum = 0;
+      for (size_t i = start; i < end; ++i)
+      {
+        sum += abs(to_signed8(samples[i]));
+
+        if (with_quiet_samples && is_quiet(samples[i]))
+        {
+          quiet_samples[i / 8] |= static_cast<ALubyte>(1 << (i % 8));
+        }
+      }
+
+      amplitudes[window] = static_cast<ALubyte>(sum / static_cast<int>(end - start));
+    }
+  }
+
+  void SoundEnvelope::Build(alure::ArrayView<ALbyte> data, alure::SampleType type, alure::ChannelConfig channels, bool with_quiet_samples)
+  {
+    m_amplitudes.clear();
+    m_quiet_samples.clear();
+    m_length = 0;
+
+    // mouth movement and sentences only support mono
+    if (channels != alure::ChannelConfig::Mono)
+    {
+      return;
+    }
+
+    // the same conversions and thresholds the mouth movement and the trimming used on the PCM
+    switch (type)
+    {
+    case alure::SampleType::UInt8:
+    {
+      auto samples = data.reinterpret_as<ALubyte>();
+      m_length = samples.size();
+      BuildFromSamples(samples, m_amplitudes, m_quiet_samples, with_quiet_samples,
+        [](ALubyte sample) { return sample + SCHAR_MIN; },
+        [](ALubyte sample) { return sample + SCHAR_MIN >= -2 && sample + SCHAR_MIN <= 2; });
+      break;
+    }
+    case alure::SampleType::Int16:
+    {
+      auto samples = data.reinterpret_as<int16_t>();
+      m_length = samples.size();
+      BuildFromSamples(samples, m_amplitudes, m_quiet_samples, with_quiet_samples,
+        [](int16_t sample) { return std::clamp(sample >> 8, SCHAR_MIN, SCHAR_MAX); },
+        [](int16_t sample) { return sample >= -512 && sample <= 512; });
+      break;
+    }
+    case alure::SampleType::Float32:
+    {
+      auto samples = data.reinterpret_as<float>();
+      m_length = samples.size();
+      BuildFromSamples(samples, m_amplitudes, m_quiet_samples, with_quiet_samples,
+        [](float sample) { return std::clamp(static_cast<int>(sample * 128), SCHAR_MIN, SCHAR_MAX); },
+        [](float sample) { return sample >= -0.016 && sample <= 0.016; });
+      break;
+    }
+    default:
+      break;
+    }
+  }
+
+  bool SoundEnvelope::IsQuiet(size_t sample) const
+  {
+    if (sample >= m_length || m_quiet_samples.empty())
+    {
+      return false;
+    }
+
+    return (m_quiet_samples[sample / 8] & (1 << (sample % 8))) != 0;
+  }
+
+  size_t SoundEnvelope::GetMemoryUsage() const
+  {
+    return m_amplitudes.capacity() + m_quiet_samples.capacity();
+  }
+}
@@ -0,0 +1,144 @@
+#include "Utilities/SoundEventLog.hpp"
+
+#include <sstream>
+
+namespace MetaAudio
+{
+  // the first line of the file, the sound name is the last field of a line since it may contain spaces
+  static constexpr char LOG_HEADER[] = "sound_events 1";
+
+  static void WriteVector(std::ofstream& file, const float* vector)
+  {
+    file << ' ' << vector[0] << ' ' << vector[1] << ' ' << vector[2];
+  }
+
+  static bool ReadVector(std::istringstream& stream, vec3_t vector)
+  {
+    return static_cast<bool>(stream >> vector[0] >> vector[1] >> vector[2]);
+  }
+
+  bool SoundEventLog::StartRecording(const std::filesystem::path& path)
+  {
+    StopRecording();
+
+    m_file.open(path, std::ios::out | std::ios::trunc);
+    if (!m_file.is_open())
+      return false;
+
+    // the positions are written with enough digits to replay the same spatialization
+    m_file.precision(9);
+    m_file << LOG_HEADER << '\n';
+    m_frames = 0;
+
+    return true;
+  }
+
+  size_t SoundEventLog::StopRecording()
+  {
+    if (m_file.is_open())
+      m_file.close();
+
+    return m_frames;
+  }
+
+  void SoundEventLog::RecordFrame(float frame_time, const float* origin, const float* forward, const float* right, const float* up)
+  {
+    if (!m_file.is_open())
+      return;
+
+    m_file << "frame " << frame_time;
+    WriteVector(m_file, origin);
+    WriteVector(m_file, forward);
+    WriteVector(m_file, right);
+    WriteVector(m_file, up);
+    m_file << '\n';
+
+    ++m_frames;
+  }
+
+  void SoundEventLog::RecordStart(bool is_static, int entnum, int entchannel, const sfx_t* sfx, const float* origin, float fvol, float attenuation, int flags, int pitch)
+  {
+    if (!m_file.is_open() || sfx == nullptr)
+      return;
+
+    static const vec3_t zero_origin{};
+
+    m_file << (is_static ? "static " : "start ") << entnum << ' ' << entchannel;
+    WriteVector(m_file, origin != nullptr ? origin : zero_origin);
+    m_file << ' ' << fvol << ' ' << attenuation << ' ' << flags << ' ' << pitch << ' ' << sfx->name << '\n';
+  }
+
+  void SoundEventLog::RecordStop(int entnum, int entchannel)
+  {
+    if (!m_file.is_open())
+      return;
+
+    m_file << "stop " << entnum << ' ' << entchannel << '\n';
+  }
+
+  void SoundEventLog::RecordStopAll(bool clear)
+  {
+    if (!m_file.is_open())
+      return;
+
+    m_file << "stopall " << (clear ? 1 : 0) << '\n';
+  }
+
+  bool SoundEventLog::Load(const std::filesystem::path& path, alure::Vector<SoundEvent>& events)
+  {
+    std::ifstream file(path);
+    if (!file.is_open())
+      return false;
+
+    std::string line;
+    if (!std::getline(file, line) || line != LOG_HEADER)
+      return false;
+
+    while (std::getline(file, line))
+    {
+      std::istringstream stream(line);
+      std::string type;
+      stream >> type;
+
+      SoundEvent event;
+      bool is_valid = false;
+
+      if (type == "frame")
+      {
+        event.type = SoundEventType::Frame;
+        is_valid = stream >> event.frame_time &&
+          ReadVector(stream, event.origin) &&
+          ReadVector(stream, event.forward) &&
+          ReadVector(stream, event.right) &&
+          ReadVector(stream, event.up);
+      }
+      else if (type == "start" || type == "static")
+      {
+        event.type = type == "start" ? SoundEventType::Start : SoundEventType::StartStatic;
+        is_valid = stream >> event.entnum >> event.entchannel &&
+          ReadVector(stream, event.origin) &&
+          stream >> event.fvol >> event.attenuation >> event.flags >> event.pitch &&
+          stream.get() == ' ' &&
+          std::getline(stream, event.name) &&
+          !event.name.empty();
+      }
+      else if (type == "stop")
+      {
+        event.type = SoundEventType::Stop;
+        is_valid = static_cast<bool>(stream >> event.entnum >> event.entchannel);
+      }
+      else if (type == "stopall")
+      {
+        int clear = 0;
+        event.type = SoundEventType::StopAll;
+        is_valid = static_cast<bool>(stream >> clear);
+        event.clear = clear != 0;
+      }
+
+      if (is_valid)
+        events.emplace_back(std::move(event));
+    }
+
+    return true;
+  }
+}
@@ -1,8 +1,10 @@
 #include <algorithm>
-#include <regex>
 #include <cctype>
+#include <charconv>
+#include <chrono>
 
 #include "Vox/VoxManager.hpp"
+#include "Vox/VoxTokenizer.hpp"
 
 #include <metaaudio.h>
 
@@ -54,71 +56,26 @@ namespace MetaAudio
     if (sstart > send)
       return;
 
-    alure::ArrayView<ALubyte> data_viewer = sc->data;
     if (sstart > 0 && sstart < 100)
     {
       skiplen = static_cast<int>(length * (sstart / 100));
       srcsample = static_cast<size_t>(ch->start);
       ch->start += skiplen;
 
-      if (!sc->data.empty() && ch->start < length)
+      if (!sc->envelope.empty() && ch->start < length)
       {
-        switch (sc->stype)
+        for (size_t i = 0; i < CVOXZEROSCANMAX; ++i)
         {
-        case alure::SampleType::UInt8:
-        {
-          auto temp_viewer = data_viewer.reinterpret_as<ALubyte>();
-          for (size_t i = 0; i < CVOXZEROSCANMAX; ++i)
-          {
-            if (srcsample >= sc->length)
-              break;
+          if (srcsample >= sc->length)
+            break;
 
-            if (temp_viewer[srcsample] + SCHAR_MIN >= -2 && temp_viewer[srcsample] + SCHAR_MIN <= 2)
-            {
-              ch->start += 1;
-              break;
-            }
-
-            srcsample++;
-          }
-          break;
-        }
-        case alure::SampleType::Int16:
-        {
-          auto temp_viewer = data_viewer.reinterpret_as<int16>();
-          for (size_t i = 0; i < CVOXZEROSCANMAX; ++i)
+          if (sc->envelope.IsQuiet(srcsample))
           {
-            if (srcsample >= sc->length)
-              break;
-
-            if (temp_viewer[srcsample] >= -512 && temp_viewer[srcsample] <= 512)
-            {
-              ch->start += 1;
-              break;
-            }
-
-            srcsample++;
+            ch->start += 1;
+            break;
           }
-          break;
-        }
-        case alure::SampleType::Float32:
-        {
-          auto temp_viewer = data_viewer.reinterpret_as<float>();
-          for (size_t i = 0; i < CVOXZEROSCANMAX; ++i)
-          {
-            if (srcsample >= sc->length)
-              break;
-
-            if (temp_viewer[srcsample] >= -0.016 && temp_viewer[srcsample] <= 0.016)
-            {
-              ch->start += 1;
-              break;
-            }
 
-            srcsample++;
-          }
-          break;
-        }
+          srcsample++;
         }
       }
 
@@ -134,76 +91,24 @@ namespace MetaAudio
       ch->end -= skiplen;
       pvoxword->cbtrim -= skiplen;
 
-      if (!sc->data.empty() && ch->start < length)
+      if (!sc->envelope.empty() && ch->start < length)
       {
-        switch (sc->stype)
-        {
-        case alure::SampleType::UInt8:
+        for (size_t i = 0; i < CVOXZEROSCANMAX; ++i)
         {
-          auto temp_viewer = data_viewer.reinterpret_as<ALubyte>();
-          for (size_t i = 0; i < CVOXZEROSCANMAX; ++i)
-          {
-            if (srcsample <= ch->start)
-              break;
-
-            if (temp_viewer[srcsample] + SCHAR_MIN >= -2 && temp_viewer[srcsample] + SCHAR_MIN <= 2)
-            {
-              ch->end -= 1;
-              pvoxword->cbtrim -= 1;
-            }
-            else
-            {
-              break;
-            }
-
-            srcsample--;
-          }
-          break;
-        }
-        case alure::SampleType::Int16:
-        {
-          auto temp_viewer = data_viewer.reinterpret_as<int16>();
-          for (size_t i = 0; i < CVOXZEROSCANMAX; ++i)
+          if (srcsample <= ch->start)
+            break;
+
+          if (sc->envelope.IsQuiet(srcsample))
           {
-            if (srcsample <= ch->start)
-              break;
-
-            if (temp_viewer[srcsample] >= -512 && temp_viewer[srcsample] <= 512)
-            {
-              ch->end -= 1;
-              pvoxword->cbtrim -= 1;
-            }
-            else
-            {
-              break;
-            }
-
-            srcsample--;
+            ch->end -= 1;
+            pvoxword->cbtrim -= 1;
           }
-          break;
-        }
-        case alure::SampleType::Float32:
-        {
-          auto temp_viewer = data_viewer.reinterpret_as<float>();
-          for (size_t i = 0; i < CVOXZEROSCANMAX; ++i)
+          else
           {
-            if (srcsample <= ch->start)
-              break;
-
-            if (temp_viewer[srcsample] >= -0.016 && temp_viewer[srcsample] <= 0.016)
-            {
-              ch->end -= 1;
-              pvoxword->cbtrim -= 1;
-            }
-            else
-            {
-              break;
-            }
-
-            srcsample--;
+            break;
           }
-          break;
-        }
+
+          srcsample--;
         }
       }
     }
@@ -231,9 +136,57 @@ namespace MetaAudio
     }
   }
 
+  size_t VoxManager::SentenceNameHash::operator()(std::string_view name) const
+  {
+    // FNV-1a over the lowercase name
+    size_t hash = 14695981039346656037ULL;
+    for (unsigned char c : name)
+    {
+      hash ^= static_cast<size_t>(std::tolower(c));
+      hash *= 1099511628211ULL;
+    }
+
+    return hash;
+  }
+
+  bool VoxManager::SentenceNameEqual::operator()(std::string_view a, std::string_view b) const
+  {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](unsigned char lhs, unsigned char rhs)
+    {
+      return std::tolower(lhs) == std::tolower(rhs);
+    });
+  }
+
+  bool VoxManager::IsSentenceIndexValid() const
+  {
+    int count = *p_cszrawsentences;
+    const char* first = count > 0 ? (*p_rgpszrawsentence)[0] : nullptr;
+
+    return m_indexed_sentences_count == count && m_indexed_first_sentence == first;
+  }
+
+  void VoxManager::IndexSentences()
+  {
+    m_sentence_index.clear();
+
+    m_indexed_sentences_count = *p_cszrawsentences;
+    m_indexed_first_sentence = m_indexed_sentences_count > 0 ? (*p_rgpszrawsentence)[0] : nullptr;
+
+    m_sentence_index.reserve(m_indexed_sentences_count);
+    for (int i = 0; i < m_indexed_sentences_count; ++i)
+    {
+      const char* name = (*p_rgpszrawsentence)[i];
+      if (name == nullptr)
+        continue;
+
+      // the first of the sentences with the same name wins, like with the linear search
+      m_sentence_index.emplace(std::string_view(name), i);
+    }
+  }
+
   std::optional<alure::String> VoxManager::LookupString(const alure::String& pszin, int* psentencenum)
   {
-    char* cptr;
+    const char* cptr;
     sentenceEntry_s* sentenceEntry;
 
     if (pszin[0] == '#')
@@ -244,21 +197,22 @@ namespace MetaAudio
         return alure::String(sentenceEntry->data);
     }
 
-    for (size_t i = 0, final = *p_cszrawsentences; i < final; ++i)
-    {
-      if (!_stricmp(pszin.c_str(), (*p_rgpszrawsentence)[i]))
-      {
-        if (psentencenum)
-          *psentencenum = i;
+    if (!IsSentenceIndexValid())
+      IndexSentences();
 
-        cptr = &(*p_rgpszrawsentence)[i][strlen((*p_rgpszrawsentence)[i]) + 1];
-        while (*cptr == ' ' || *cptr == '\t')
-          cptr++;
+    auto it = m_sentence_index.find(std::string_view(pszin.c_str()));
+    if (it == m_sentence_index.end())
+      return std::nullopt;
 
-        return alure::String(cptr);
-      }
-    }
-    return std::nullopt;
+    if (psentencenum)
+      *psentencenum = it->second;
+
+    // the sentence follows the null terminator of the name
+    cptr = it->first.data() + it->first.size() + 1;
+    while (*cptr == ' ' || *cptr == '\t')
+      cptr++;
+
+    return alure::String(cptr);
   }
 
   alure::Vector<std::tuple<alure::StringView, alure::StringView>> VoxManager::GetDirectory(const alure::String& psz)
@@ -315,46 +269,15 @@ namespace MetaAudio
     return ret;
   }
 
-  // Regex for matching:
-  // 1. Comma and periods
-  // 2. Words with parameters and just parameteres. For ex.: (p110 t40) clik!(p120)
-  // 3. Full words. For ex.: clik
-  static const std::regex regex_match_vox(R"([,.]|[^\s,.]*\(.+?\)|\b[^\s,.]*[^\s.,])");
-  alure::Vector<alure::String> VoxManager::ParseString(const alure::StringView& input)
+  alure::Vector<std::string_view> VoxManager::ParseString(std::string_view psz)
   {
-    const auto psz = alure::String(input);
-
-    alure::Vector<alure::String> words;
-
-    if (!psz.length())
-      return words;
-
-    auto matches_begin = std::sregex_iterator(psz.cbegin(), psz.cend(), regex_match_vox);
-    auto matches_end = std::sregex_iterator();
-    while (matches_begin != matches_end) {
-      auto& match = *matches_begin;
-      const alure::String& sub_match = match[0];
-      if (sub_match == ",")
-      {
-        words.push_back(voxcomma);
-      }
-      else if (sub_match == ".")
-      {
-        words.push_back(voxperiod);
-      }
-      else
-      {
-        words.push_back(sub_match);
-      }
-      ++matches_begin;
-    }
-
-    return words;
+    return TokenizeVox(psz, voxcomma, voxperiod);
   }
 
-  std::optional<voxword_t> VoxManager::ParseWordParams(alure::String& initial_string, int fFirst)
+  std::optional<voxword_t> VoxManager::ParseWordParams(std::string_view& psz, int fFirst)
   {
-    const auto psz = alure::StringView(initial_string);
+    // the reads past the end return the null terminator
+    auto at = [&psz](size_t index) { return index < psz.length() ? psz[index] : '\0'; };
 
     // init to defaults if this is the first word in string.
     if (fFirst)
@@ -371,7 +294,7 @@ namespace MetaAudio
     // valid format:
     size_t charscan_index = psz.length() - 1;
 
-    if (psz[charscan_index] != ')')
+    if (at(charscan_index) != ')')
       return voxword;  // no formatting, return
 
     // scan forward to first '('
@@ -379,63 +302,60 @@ namespace MetaAudio
     while (charscan_index < psz.length() && !(psz[charscan_index] == '(' || psz[charscan_index] == ')'))
       ++charscan_index;
 
-    if (psz[charscan_index] == ')')
+    if (at(charscan_index) == ')')
       return std::nullopt;  // bogus formatting
 
     // to eventually remove parameter block from initial string
     auto parameter_block_index = charscan_index;
 
-    alure::String ct;
-    ct = psz[++charscan_index];
-    auto ValidCharacter = [](char& character) { return character == 'v' || character == 'p' || character == 's' || character == 'e' || character == 't'; };
+    char ct = at(++charscan_index);
+    auto ValidCharacter = [](char character) { return character == 'v' || character == 'p' || character == 's' || character == 'e' || character == 't'; };
     while (1)
     {
       // scan until we hit a character in the commandSet
       while (charscan_index < psz.length() && psz[charscan_index] != ')' &&
-             !ValidCharacter(ct[0]))
+             !ValidCharacter(ct))
       {
-        ct = psz[++charscan_index];
+        ct = at(++charscan_index);
       }
 
-      if (psz[charscan_index] == ')')
+      if (at(charscan_index) == ')')
         break;
 
       ++charscan_index;
-      if (!std::isdigit(psz[charscan_index]))
+      if (!std::isdigit(static_cast<unsigned char>(at(charscan_index))))
         break;
 
       // read number
-      alure::String sznum = "";
-      while (std::isdigit(psz[charscan_index]))
-      {
-        sznum += psz[charscan_index];
+      auto number_start = charscan_index;
+      while (std::isdigit(static_cast<unsigned char>(at(charscan_index))))
         ++charscan_index;
-      }
 
-      switch (ct[0])
+      int value = 0;
+      std::from_chars(psz.data() + number_start, psz.data() + charscan_index, value);
+
+      switch (ct)
       {
-      case 'v': voxword.volume = std::stoi(sznum); break;
-      case 'p': voxword.pitch = std::stoi(sznum); break;
-      case 's': voxword.start = std::stoi(sznum); break;
-      case 'e': voxword.end = std::stoi(sznum); break;
-      case 't': voxword.timecompress = std::stoi(sznum); break;
+      case 'v': voxword.volume = value; break;
+      case 'p': voxword.pitch = value; break;
+      case 's': voxword.start = value; break;
+      case 'e': voxword.end = value; break;
+      case 't': voxword.timecompress = value; break;
       }
 
-      ct = psz[charscan_index];
+      ct = at(charscan_index);
     }
 
+    psz = psz.substr(0, parameter_block_index);
+
     // isolated parameter block
-    if (psz[0] == '(')
+    if (parameter_block_index == 0)
     {
-      initial_string.assign(initial_string, 0, parameter_block_index);
       voxwordDefault = voxword;
       return std::nullopt;
     }
-    else
-    {
-      initial_string.assign(initial_string, 0, parameter_block_index);
-      return voxword;
-    }
+
+    return voxword;
   }
 
   aud_sfxcache_t* VoxManager::LoadSound(aud_channel_t* channel, const alure::String& pszin)
@@ -479,7 +399,9 @@ namespace MetaAudio
         {
           auto& value = voxParameter.value();
           // this is a valid word (as opposed to a parameter block)
-          auto pathbuffer = std::get<0>(sentence) + words[i] + ".wav";
+          auto pathbuffer = alure::String(std::get<0>(sentence));
+          pathbuffer.append(words[i]);
+          pathbuffer.append(".wav");
 
           // find name, if already in cache, mark voxword
           // so we don't discard when word is done playing
@@ -544,8 +466,7 @@ namespace MetaAudio
 
   void VoxManager::MoveMouth(aud_channel_t* ch, aud_sfxcache_t* sc)
   {
-    int data;
-    size_t i;
+    size_t window;
     int savg;
     int scount;
     cl_entity_t* pent;
@@ -555,52 +476,17 @@ namespace MetaAudio
     if (!pent)
       return;
 
-    i = static_cast<size_t>(ch->sound_source->GetSampleOffset());
+    // one envelope window stands for one amplitude sample of the original PCM scan
+    window = static_cast<size_t>(ch->sound_source->GetSampleOffset()) / SoundEnvelope::WINDOW_SIZE;
     scount = pent->mouth.sndcount;
     savg = 0;
 
-    alure::ArrayView<ALubyte> data_viewer = sc->data;
-    switch (sc->stype)
-    {
-    case alure::SampleType::UInt8:
-    {
-      auto temp_viewer = data_viewer.reinterpret_as<ALubyte>();
-      while (i < sc->length && scount < CAVGSAMPLES)
-      {
-        data = temp_viewer[i] + SCHAR_MIN;
-        savg += abs(data);
-
-        i += 80 + ((byte)data & 0x1F);
-        scount++;
-      }
-      break;
-    }
-    case alure::SampleType::Int16:
-    {
-      auto temp_viewer = data_viewer.reinterpret_as<int16>();
-      while (i < sc->length && scount < CAVGSAMPLES)
-      {
-        data = std::clamp(temp_viewer[i] >> 8, SCHAR_MIN, SCHAR_MAX);
-        savg += abs(data);
-
-        i += 80 + ((byte)data & 0x1F);
-        scount++;
-      }
-      break;
-    }
-    case alure::SampleType::Float32:
+    while (window < sc->envelope.GetWindowsCount() && scount < CAVGSAMPLES)
     {
-      auto temp_viewer = data_viewer.reinterpret_as<float>();
-      while (i < sc->length && scount < CAVGSAMPLES)
-      {
-        data = std::clamp(static_cast<int>(temp_viewer[i] * 128), SCHAR_MIN, SCHAR_MAX);
-        savg += abs(data);
+      savg += sc->envelope.GetAmplitude(window);
 
-        i += 80 + ((byte)data & 0x1F);
-        scount++;
-      }
-      break;
-    }
+      window++;
+      scount++;
     }
 
     pent->mouth.sndavg += savg;
@@ -613,4 +499,80 @@ namespace MetaAudio
       pent->mouth.sndcount = 0;
     }
   }
-}
\ No newline at end of file
+
+  void VoxManager::Benchmark(int iterations)
+  {
+    IndexSentences();
+
+    // the sentences are split into the directory parts once, only the tokenizer and the lookups are timed
+    alure::Vector<alure::String> names;
+    alure::Vector<alure::String> sentences;
+    for (int i = 0; i < m_indexed_sentences_count; ++i)
+    {
+      const char* name = (*p_rgpszrawsentence)[i];
+      if (name == nullptr)
+        continue;
+
+      auto sentence = LookupString(name, nullptr);
+      if (!sentence.has_value())
+        continue;
+
+      names.emplace_back(name);
+      sentences.emplace_back(std::move(sentence.value()));
+    }
+
+    alure::Vector<std::string_view> parts;
+    for (const auto& sentence : sentences)
+    {
+      for (const auto& directory : GetDirectory(sentence))
+        parts.emplace_back(std::get<1>(directory));
+    }
+
+    size_t words_count = 0;
+    for (auto part : parts)
+      words_count += ParseString(part).size();
+
+    auto measure = [iterations](auto&& func)
+    {
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; ++i)
+        func();
+      return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    size_t sink = 0;
+    double tokenizer_time = measure([&]
+    {
+      for (auto part : parts)
+        sink += ParseString(part).size();
+    });
+    double linear_lookup_time = measure([&]
+    {
+      for (const auto& name : names)
+      {
+        for (int i = 0; i < m_indexed_sentences_count; ++i)
+        {
+          const char* entry = (*p_rgpszrawsentence)[i];
+          if (entry != nullptr && !_stricmp(name.c_str(), entry))
+          {
+            sink += i;
+            break;
+          }
+        }
+      }
+    });
+    double hashed_lookup_time = measure([&]
+    {
+      for (const auto& name : names)
+      {
+        auto it = m_sentence_index.find(std::string_view(name));
+        if (it != m_sentence_index.end())
+          sink += it->second;
+      }
+    });
+
+    gEngfuncs.Con_Printf("VOX benchmark, %zu sentences, %zu words, %d iterations (%zu):\n", sentences.size(), words_count, iterations, sink);
+    gEngfuncs.Con_Printf("  tokenizer: %.2f ms\n", tokenizer_time);
+    gEngfuncs.Con_Printf("  lookup: linear %.2f ms, hashed %.2f ms\n", linear_lookup_time, hashed_lookup_time);
+  }
+}
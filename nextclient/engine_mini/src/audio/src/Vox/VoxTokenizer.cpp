@@ -0,0 +1,92 @@
+#include "Vox/VoxTokenizer.hpp"
+
+#include <cctype>
+
+namespace MetaAudio
+{
+  static bool IsVoxWordChar(char c)
+  {
+    return !std::isspace(static_cast<unsigned char>(c)) && c != ',' && c != '.';
+  }
+
+  static bool IsBoundaryWordChar(char c)
+  {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+  }
+
+  // Finds the end of a word with a parameter block which starts in the word at [start, word_end).
+  // The block may contain spaces, for ex.: (p110 t40) clik!(p120)
+  static size_t FindParameterBlockEnd(std::string_view psz, size_t start, size_t word_end)
+  {
+    // the last '(' of the word which has a ')' after it is used
+    for (size_t open = word_end; open-- > start;)
+    {
+      if (psz[open] != '(')
+        continue;
+
+      for (size_t i = open + 1; i < psz.size() && psz[i] != '\n' && psz[i] != '\r'; ++i)
+      {
+        // the block isn't empty
+        if (psz[i] == ')' && i > open + 1)
+          return i + 1;
+      }
+    }
+
+    return std::string_view::npos;
+  }
+
+  alure::Vector<std::string_view> TokenizeVox(std::string_view psz, std::string_view comma, std::string_view period)
+  {
+    alure::Vector<std::string_view> words;
+
+    size_t position = 0;
+    while (position < psz.size())
+    {
+      char c = psz[position];
+      if (c == ',')
+      {
+        words.push_back(comma);
+        position++;
+        continue;
+      }
+
+      if (c == '.')
+      {
+        words.push_back(period);
+        position++;
+        continue;
+      }
+
+      if (!IsVoxWordChar(c))
+      {
+        position++;
+        continue;
+      }
+
+      size_t word_end = position;
+      while (word_end < psz.size() && IsVoxWordChar(psz[word_end]))
+        word_end++;
+
+      size_t block_end = FindParameterBlockEnd(psz, position, word_end);
+      if (block_end != std::string_view::npos)
+      {
+        words.push_back(psz.substr(position, block_end - position));
+        position = block_end;
+        continue;
+      }
+
+      // full words start on a word boundary, the rest of the word is skipped up to the next one
+      bool is_prev_word_char = position > 0 && IsBoundaryWordChar(psz[position - 1]);
+      if (is_prev_word_char != IsBoundaryWordChar(c))
+      {
+        words.push_back(psz.substr(position, word_end - position));
+        position = word_end;
+        continue;
+      }
+
+      position++;
+    }
+
+    return words;
+  }
+}
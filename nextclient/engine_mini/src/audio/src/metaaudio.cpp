@@ -18,6 +18,10 @@ static void AL_Version() { audio_engine->AL_Version(); }
 static void AL_ResetEFX() { audio_engine->AL_ResetEFX(); }
 static void AL_BasicDevices() { audio_engine->AL_Devices(true); }
 static void AL_FullDevices() { audio_engine->AL_Devices(false); }
+static void AL_MemoryReport() { audio_engine->AL_MemoryReport(); }
+static void AL_VoxBenchmark() { audio_engine->AL_VoxBenchmark(Cmd_Argc() > 1 ? std::max(std::atoi(Cmd_Argv(1)), 1) : 100); }
+static void AL_RecordEvents() { audio_engine->AL_RecordEvents(Cmd_Argc() > 1 ? Cmd_Argv(1) : nullptr); }
+static void AL_ReplayEvents() { audio_engine->AL_ReplayEvents(Cmd_Argc() > 1 ? Cmd_Argv(1) : nullptr); }
 
 void AUDIO_Init()
 {
@@ -92,6 +96,10 @@ void AUDIO_RegisterCommands()
     gEngfuncs.pfnAddCommand("al_reset_efx", AL_ResetEFX);
     gEngfuncs.pfnAddCommand("al_show_basic_devices", AL_BasicDevices);
     gEngfuncs.pfnAddCommand("al_show_full_devices", AL_FullDevices);
+    gEngfuncs.pfnAddCommand("al_memory_report", AL_MemoryReport);
+    gEngfuncs.pfnAddCommand("al_vox_benchmark", AL_VoxBenchmark);
+    gEngfuncs.pfnAddCommand("al_record_events", AL_RecordEvents);
+    gEngfuncs.pfnAddCommand("al_replay_events", AL_ReplayEvents);
 }
 
 sfx_t* S_PrecacheSound(char *sample)
@@ -101,12 +109,26 @@ sfx_t* S_PrecacheSound(char *sample)
     return eng()->S_PrecacheSound.InvokeChained(sample);
 }
 
+void S_EvictStaleSounds()
+{
+    if (audio_engine)
+        audio_engine->S_EvictStaleSounds();
+}
+
 void S_UnloadSounds(const std::vector<std::string>& names)
 {
     // TODO implement this
     //sound_loader->S_UnloadSounds(names);
 }
 
+void S_OnFileDownloaded(const char* filename)
+{
+    if (!sound_loader || Q_strnicmp(filename, "sound/", 6))
+        return;
+
+    sound_loader->InvalidateResolvedPaths();
+}
+
 sfxcache_t* S_LoadSound(sfx_t* sound, channel_t* channel)
 {
     return eng()->S_LoadSound(sound, channel);
@@ -1,6 +1,7 @@
 #include "cl_main.h"
 #include "../engine.h"
 #include <optick.h>
+#include <metaaudio.h>
 
 #include "cl_private_resources.h"
 #include "spriteapi.h"
@@ -9,6 +10,7 @@
 #include "../console/console.h"
 #include "../common/common.h"
 #include "../common/model.h"
+#include "../common/model_prefetch.h"
 #include "../common/zone.h"
 #include "../common/cvar.h"
 #include "../common/com_strings.h"
@@ -176,6 +178,21 @@ bool CL_PrecacheResources()
 
     PrivateRes_PrepareToPrecache();
 
+    // read the model files on the thread pool while the models before them are parsed
+    std::vector<std::string> models_to_prefetch;
+    for (p = cl->resourcesonhand.pNext; p != nullptr && p != &cl->resourcesonhand; p = p->pNext)
+    {
+        if (p->type != t_model || FBitSet(p->ucFlags, RES_PRECACHED) || p->szFileName[0] == '*')
+            continue;
+
+        if (fs_lazy_precache->value != 0.0 && Q_strnicmp(p->szFileName, "maps", 4))
+            continue;
+
+        if (!Mod_IsLoaded(p->szFileName))
+            models_to_prefetch.emplace_back(p->szFileName);
+    }
+    ModPrefetch_Begin(models_to_prefetch);
+
     for (p = cl->resourcesonhand.pNext; p != &cl->resourcesonhand; p = p->pNext)
     {
         if (p == nullptr)
@@ -208,6 +225,7 @@ bool CL_PrecacheResources()
                 }
 
                 COM_ExplainDisconnection(true, "Cannot continue without sound %s, disconnecting.", p->szFileName);
+                ModPrefetch_End();
                 CL_Disconnect();
                 return false;
 
@@ -244,6 +262,7 @@ bool CL_PrecacheResources()
                     if (FBitSet(p->ucFlags, RES_FATALIFMISSING))
                     {
                         COM_ExplainDisconnection(true, "Cannot continue without model %s, disconnecting.", p->szFileName);
+                        ModPrefetch_End();
                         CL_Disconnect();
 
                         return false;
@@ -282,12 +301,16 @@ bool CL_PrecacheResources()
                 }
 
                 COM_ExplainDisconnection(true, "Cannot continue without script %s, disconnecting.", p->szFileName);
+                ModPrefetch_End();
                 CL_Disconnect();
 
                 return false;
         }
     }
 
+    ModPrefetch_End();
+    S_EvictStaleSounds();
+
     if (fs_startup_timings->value != 0.0)
         AddStartupTiming("end  CL_PrecacheResources()");
 
@@ -1,3 +1,4 @@
+#include <filesystem>
 #include "../engine.h"
 #include "download.h"
 #include "cl_spectator.h"
@@ -135,6 +136,16 @@ int CL_EstimateNeededResources()
 
     client_stateex.resourcesNeeded.clear();
 
+    // hash the existing private resources in parallel, the checks below take the crc32 from the resource index
+    std::vector<resource_descriptor_t> private_resources;
+    for (p = cl->resourcesneeded.pNext; p != &cl->resourcesneeded; p = p->pNext)
+    {
+        resource_descriptor_t resource_descriptor = ResDesc_Make(p);
+        if (resource_descriptor.private_resource && std::filesystem::exists(resource_descriptor.save_path))
+            private_resources.emplace_back(std::move(resource_descriptor));
+    }
+    ResDesc_CalcFilesCRC32(private_resources);
+
     for (p = cl->resourcesneeded.pNext; p != &cl->resourcesneeded; p = p->pNext)
     {
         resource_descriptor_t resource_descriptor = ResDesc_Make(p);
@@ -181,6 +192,8 @@ int CL_EstimateNeededResources()
         }
     }
 
+    ResDesc_SaveIndex();
+
     return nTotalSize;
 }
 
@@ -624,6 +637,8 @@ void CL_BatchResourceRequest()
         }
     }
 
+    ResDesc_SaveIndex();
+
     int queue_size = CL_HttpGetDownloadQueueSize();
     if (queue_size > 0)
     {
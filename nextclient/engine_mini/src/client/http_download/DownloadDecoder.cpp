@@ -0,0 +1,128 @@
+#include "DownloadDecoder.h"
+
+DownloadDecoder::DownloadDecoder(PrecompressedEncoding encoding) :
+    encoding_(encoding)
+{
+    switch (encoding_)
+    {
+        case PrecompressedEncoding::Zstd:
+            zstd_stream_ = ZSTD_createDCtx();
+            is_failed_ = zstd_stream_ == nullptr;
+            output_buffer_.resize(ZSTD_DStreamOutSize());
+            break;
+
+        case PrecompressedEncoding::Gzip:
+            // 16 + MAX_WBITS accepts only the gzip format
+            is_zlib_initialized_ = inflateInit2(&zlib_stream_, 16 + MAX_WBITS) == Z_OK;
+            is_failed_ = !is_zlib_initialized_;
+            output_buffer_.resize(64 * 1024);
+            break;
+
+        default:
+            is_failed_ = true;
+            break;
+    }
+}
+
+DownloadDecoder::~DownloadDecoder()
+{
+    if (zstd_stream_ != nullptr)
+        ZSTD_freeDCtx(zstd_stream_);
+
+    if (is_zlib_initialized_)
+        inflateEnd(&zlib_stream_);
+}
+
+bool DownloadDecoder::Decode(std::string_view data, const std::function<bool(std::string_view decoded_data)>& write)
+{
+    if (is_failed_)
+        return false;
+
+    return encoding_ == PrecompressedEncoding::Zstd ? DecodeZstd(data, write) : DecodeGzip(data, write);
+}
+
+bool DownloadDecoder::DecodeZstd(std::string_view data, const std::function<bool(std::string_view decoded_data)>& write)
+{
+    ZSTD_inBuffer input = {data.data(), data.size(), 0};
+
+    // the output buffer may be filled before the input is consumed, the rest of the frame is kept by the context
+    while (input.pos < input.size || !is_finished_)
+    {
+        ZSTD_outBuffer output = {output_buffer_.data(), output_buffer_.size(), 0};
+
+        size_t frame_remaining = ZSTD_decompressStream(zstd_stream_, &output, &input);
+        if (ZSTD_isError(frame_remaining))
+        {
+            is_failed_ = true;
+            return false;
+        }
+
+        // 0 is returned at the end of a frame, a file may consist of several frames
+        is_finished_ = frame_remaining == 0;
+
+        if (output.pos > 0 && !write(std::string_view(output_buffer_.data(), output.pos)))
+            return false;
+
+        if (input.pos == input.size && output.pos < output.size)
+            break;
+    }
+
+    return true;
+}
+
+bool DownloadDecoder::DecodeGzip(std::string_view data, const std::function<bool(std::string_view decoded_data)>& write)
+{
+    zlib_stream_.next_in = (Bytef*)data.data();
+    zlib_stream_.avail_in = (uInt)data.size();
+
+    // the output buffer may be filled before the input is consumed, inflate keeps the rest of the output then
+    do
+    {
+        if (is_finished_)
+        {
+            if (zlib_stream_.avail_in == 0)
+                break;
+
+            // a file may consist of several gzip members
+            if (inflateReset(&zlib_stream_) != Z_OK)
+            {
+                is_failed_ = true;
+                return false;
+            }
+        }
+
+        zlib_stream_.next_out = (Bytef*)output_buffer_.data();
+        zlib_stream_.avail_out = (uInt)output_buffer_.size();
+
+        int status = inflate(&zlib_stream_, Z_NO_FLUSH);
+
+        // no progress is possible without more input
+        if (status == Z_BUF_ERROR && zlib_stream_.avail_in == 0)
+            break;
+
+        if (status != Z_OK && status != Z_STREAM_END)
+        {
+            is_failed_ = true;
+            return false;
+        }
+
+        is_finished_ = status == Z_STREAM_END;
+
+        size_t decoded_size = output_buffer_.size() - zlib_stream_.avail_out;
+        if (decoded_size > 0 && !write(std::string_view(output_buffer_.data(), decoded_size)))
+            return false;
+    }
+    while (zlib_stream_.avail_in > 0 || zlib_stream_.avail_out == 0);
+
+    return true;
+}
+
+const char* DownloadDecoder::GetExtension(PrecompressedEncoding encoding)
+{
+    switch (encoding)
+    {
+        case PrecompressedEncoding::Zstd: return ".zst";
+        case PrecompressedEncoding::Gzip: return ".gz";
+        default: return "";
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include <functional>
+
+#include <zlib.h>
+#include <zstd.h>
+
+// Pre-compressed copy of a file stored next to it on a static host
+enum class PrecompressedEncoding
+{
+    None = 0,
+    Zstd,
+    Gzip,
+};
+
+// Decodes the body of a pre-compressed file (<file>.zst or <file>.gz) as it arrives.
+// Static hosts serve these files as they are, without Content-Encoding, so curl doesn't decode them.
+// Decode is called from the transfer pool thread, the rest of the methods from the main thread
+// after the response future is ready.
+class DownloadDecoder
+{
+    PrecompressedEncoding encoding_;
+    ZSTD_DCtx* zstd_stream_ = nullptr;
+    z_stream zlib_stream_{};
+    bool is_zlib_initialized_ = false;
+
+    std::vector<char> output_buffer_;
+    bool is_finished_ = false;
+    bool is_failed_ = false;
+
+public:
+    explicit DownloadDecoder(PrecompressedEncoding encoding);
+    ~DownloadDecoder();
+    DownloadDecoder(const DownloadDecoder&) = delete;
+    DownloadDecoder& operator=(const DownloadDecoder&) = delete;
+
+    // Passes the decoded data to write by chunks, returns false if the data is invalid or write fails
+    bool Decode(std::string_view data, const std::function<bool(std::string_view decoded_data)>& write);
+
+    [[nodiscard]] PrecompressedEncoding get_encoding() const { return encoding_; }
+    // True if the data ended at the end of a compressed stream
+    [[nodiscard]] bool is_finished() const { return is_finished_; }
+    // True if the data is not a valid compressed stream, a write error doesn't set it
+    [[nodiscard]] bool is_failed() const { return is_failed_; }
+
+    // Suffix of the pre-compressed file name
+    static const char* GetExtension(PrecompressedEncoding encoding);
+
+private:
+    bool DecodeZstd(std::string_view data, const std::function<bool(std::string_view decoded_data)>& write);
+    bool DecodeGzip(std::string_view data, const std::function<bool(std::string_view decoded_data)>& write);
+};
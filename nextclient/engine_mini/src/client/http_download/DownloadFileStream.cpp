@@ -0,0 +1,267 @@
+#include "DownloadFileStream.h"
+#include "../../utils/Crc32.h"
+#include <algorithm>
+#include <charconv>
+#include <cctype>
+#include <vector>
+
+static bool StartsWithNoCase(std::string_view str, std::string_view prefix)
+{
+    if (str.size() < prefix.size())
+        return false;
+
+    return std::equal(prefix.cbegin(), prefix.cend(), str.cbegin(), [](char a, char b) {
+        return std::tolower((unsigned char)a) == std::tolower((unsigned char)b);
+    });
+}
+
+static std::string_view TrimHeaderValue(std::string_view value)
+{
+    while (!value.empty() && std::isspace((unsigned char)value.front()))
+        value.remove_prefix(1);
+
+    while (!value.empty() && std::isspace((unsigned char)value.back()))
+        value.remove_suffix(1);
+
+    return value;
+}
+
+DownloadFileStream::DownloadFileStream(const std::string& save_path, size_t head_size_limit) :
+    save_path_(save_path),
+    temp_path_(save_path + ".part"),
+    journal_path_(save_path + ".part.journal"),
+    head_size_limit_(head_size_limit)
+{ }
+
+DownloadFileStream::~DownloadFileStream()
+{
+    // the request was stopped before completion, keep the data for the next connection if it can be continued
+    if (file_.is_open())
+        Suspend();
+}
+
+bool DownloadFileStream::Open(bool allow_resume)
+{
+    std::error_code ec;
+
+    if (temp_path_.has_parent_path())
+        std::filesystem::create_directories(temp_path_.parent_path(), ec);
+
+    size_t journal_offset = 0;
+    std::string journal_validator;
+
+    // too short partial files are not worth resuming, and they must be downloaded
+    // from the beginning to validate the head of the file
+    if (allow_resume &&
+        LoadJournal(journal_offset, journal_validator) &&
+        journal_offset >= head_size_limit_ &&
+        std::filesystem::file_size(temp_path_, ec) == journal_offset && !ec)
+    {
+        file_.open(temp_path_, std::ios::out | std::ios::binary | std::ios::app);
+        if (file_.is_open())
+        {
+            resume_offset_ = journal_offset;
+            validator_ = std::move(journal_validator);
+            return true;
+        }
+    }
+
+    std::filesystem::remove(journal_path_, ec);
+
+    file_.open(temp_path_, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file_.is_open())
+    {
+        is_failed_ = true;
+        return false;
+    }
+
+    return true;
+}
+
+void DownloadFileStream::OnHeader(std::string_view header)
+{
+    header = TrimHeaderValue(header);
+
+    if (StartsWithNoCase(header, "HTTP/"))
+    {
+        // a new response begins, e.g. after a redirect
+        auto status_pos = header.find(' ');
+        int status_code = 0;
+        if (status_pos != std::string_view::npos)
+            std::from_chars(header.data() + status_pos + 1, header.data() + header.size(), status_code);
+
+        is_resumed_ = resume_offset_ > 0 && status_code == 206;
+        response_validator_.clear();
+        return;
+    }
+
+    if (StartsWithNoCase(header, "Content-Range:"))
+    {
+        // bytes <start>-<end>/<total>
+        auto value = TrimHeaderValue(header.substr(sizeof("Content-Range:") - 1));
+        auto start_pos = value.find(' ');
+        size_t range_start = 0;
+        if (start_pos != std::string_view::npos)
+            std::from_chars(value.data() + start_pos + 1, value.data() + value.size(), range_start);
+
+        if (is_resumed_ && range_start != resume_offset_)
+            is_failed_ = true;
+    }
+    else if (StartsWithNoCase(header, "ETag:"))
+    {
+        auto value = TrimHeaderValue(header.substr(sizeof("ETag:") - 1));
+
+        // weak validators can't be used in If-Range
+        if (!value.starts_with("W/"))
+            response_validator_ = value;
+    }
+    else if (StartsWithNoCase(header, "Last-Modified:"))
+    {
+        if (response_validator_.empty())
+            response_validator_ = TrimHeaderValue(header.substr(sizeof("Last-Modified:") - 1));
+    }
+}
+
+bool DownloadFileStream::Write(std::string_view data)
+{
+    if (is_failed_ || !file_.is_open())
+        return false;
+
+    // the server ignored the Range request or the file has changed, start from the beginning
+    if (resume_offset_ > 0 && !is_resumed_)
+        Restart();
+
+    if (head_.size() < head_size_limit_)
+        head_.append(data.substr(0, head_size_limit_ - head_.size()));
+
+    if (!file_.write(data.data(), (std::streamsize)data.size()))
+    {
+        is_failed_ = true;
+        return false;
+    }
+
+    crc32_state_ = Crc32_ProcessBuffer(crc32_state_, data.data(), data.size());
+    written_bytes_ += data.size();
+    return true;
+}
+
+bool DownloadFileStream::Commit()
+{
+    if (!file_.is_open())
+        return false;
+
+    file_.close();
+    if (is_failed_ || file_.fail())
+    {
+        Discard();
+        return false;
+    }
+
+    // the resumed part was written by the previous transfer, hash the whole file once
+    std::optional<uint32_t> crc32 = resume_offset_ > 0 ? CalcTempFileCRC32() : crc32_state_ ^ 0xFFFFFFFF;
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path_, save_path_, ec);
+    if (ec)
+    {
+        Discard();
+        return false;
+    }
+
+    std::filesystem::remove(journal_path_, ec);
+    crc32_ = crc32;
+    return true;
+}
+
+void DownloadFileStream::Suspend()
+{
+    if (file_.is_open())
+        file_.close();
+
+    if (is_failed_ || file_.fail() || !is_resumable_)
+    {
+        Discard();
+        return;
+    }
+
+    if (!response_validator_.empty())
+        validator_ = response_validator_;
+
+    // without a validator there is no way to check the file on the server is still the same
+    if (validator_.empty() || resume_offset_ + written_bytes_ == 0)
+    {
+        Discard();
+        return;
+    }
+
+    SaveJournal();
+}
+
+void DownloadFileStream::Discard()
+{
+    if (file_.is_open())
+        file_.close();
+
+    std::error_code ec;
+    std::filesystem::remove(temp_path_, ec);
+    std::filesystem::remove(journal_path_, ec);
+}
+
+bool DownloadFileStream::LoadJournal(size_t& offset, std::string& validator)
+{
+    std::ifstream journal(journal_path_);
+    if (!journal.is_open())
+        return false;
+
+    std::string offset_line;
+    if (!std::getline(journal, offset_line) || !std::getline(journal, validator))
+        return false;
+
+    auto [ptr, ec] = std::from_chars(offset_line.data(), offset_line.data() + offset_line.size(), offset);
+    if (ec != std::errc() || validator.empty())
+        return false;
+
+    return true;
+}
+
+void DownloadFileStream::SaveJournal()
+{
+    std::ofstream journal(journal_path_, std::ios::out | std::ios::trunc);
+    if (!journal.is_open())
+        return;
+
+    journal << (resume_offset_ + written_bytes_) << '\n' << validator_ << '\n';
+}
+
+void DownloadFileStream::Restart()
+{
+    file_.close();
+    file_.open(temp_path_, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file_.is_open())
+        is_failed_ = true;
+
+    resume_offset_ = 0;
+    validator_.clear();
+    crc32_state_ = 0xFFFFFFFF;
+}
+
+std::optional<uint32_t> DownloadFileStream::CalcTempFileCRC32() const
+{
+    std::ifstream file(temp_path_, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return std::nullopt;
+
+    std::vector<char> file_buffer(64 * 1024);
+    uint32_t crc_state = 0xFFFFFFFF;
+
+    while (file)
+    {
+        file.read(file_buffer.data(), (std::streamsize)file_buffer.size());
+        crc_state = Crc32_ProcessBuffer(crc_state, file_buffer.data(), (size_t)file.gcount());
+    }
+
+    if (!file.eof())
+        return std::nullopt;
+
+    return crc_state ^ 0xFFFFFFFF;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <filesystem>
+#include <optional>
+#include <cstdint>
+
+// Writes the body of a http response to a temporary file next to the destination path
+// as it arrives, and moves it to the destination path once the transfer is completed.
+// An interrupted transfer leaves the partial file and a journal with the byte offset and
+// the validator of the response, so the next request of the same file can continue it
+// with a Range request.
+// OnHeader and Write are called from the transfer pool thread, the rest of the methods from
+// the main thread before the request is started or after the response future is ready.
+class DownloadFileStream
+{
+    std::filesystem::path save_path_;
+    std::filesystem::path temp_path_;
+    std::filesystem::path journal_path_;
+    std::ofstream file_;
+
+    // the first bytes of the body, used to validate the downloaded data
+    std::string head_;
+    size_t head_size_limit_;
+
+    size_t resume_offset_ = 0;
+    size_t written_bytes_ = 0;
+    bool is_resumed_ = false;
+    bool is_failed_ = false;
+    bool is_resumable_ = true;
+
+    // crc32 of the data written by this transfer, the resumed part is hashed on commit
+    uint32_t crc32_state_ = 0xFFFFFFFF;
+    std::optional<uint32_t> crc32_;
+
+    // ETag or Last-Modified, sent back in If-Range when resuming
+    std::string validator_;
+    std::string response_validator_;
+
+public:
+    DownloadFileStream(const std::string& save_path, size_t head_size_limit);
+    ~DownloadFileStream();
+    DownloadFileStream(const DownloadFileStream&) = delete;
+    DownloadFileStream& operator=(const DownloadFileStream&) = delete;
+
+    // Opens the temporary file, continues the partial file if the journal allows it and resume is allowed
+    bool Open(bool allow_resume = true);
+    void OnHeader(std::string_view header);
+    bool Write(std::string_view data);
+    // Closes the file and atomically replaces the file at save path
+    bool Commit();
+    // Closes the file and keeps it with the journal to resume the download later, unless the stream is not resumable
+    void Suspend();
+    // Closes the file and removes it with the journal
+    void Discard();
+
+    [[nodiscard]] const std::string& get_head() const { return head_; }
+    // Offset requested in the Range header, 0 if the download starts from the beginning
+    [[nodiscard]] size_t get_resume_offset() const { return resume_offset_; }
+    [[nodiscard]] const std::string& get_validator() const { return validator_; }
+    // Number of bytes written by this transfer, not including the resumed part
+    [[nodiscard]] size_t get_written_bytes() const { return written_bytes_; }
+    // True if the server answered the Range request with the requested part
+    [[nodiscard]] bool is_resumed() const { return is_resumed_; }
+    [[nodiscard]] bool is_failed() const { return is_failed_; }
+    // The written data is not the body of the response, e.g. the decoded pre-compressed file,
+    // so the validator and the offsets of the response can't be used to continue it
+    void set_resumable(bool is_resumable) { is_resumable_ = is_resumable; }
+    [[nodiscard]] const std::filesystem::path& get_temp_path() const { return temp_path_; }
+    // The crc32 of the committed file, not set until Commit succeeds
+    [[nodiscard]] std::optional<uint32_t> get_crc32() const { return crc32_; }
+
+private:
+    bool LoadJournal(size_t& offset, std::string& validator);
+    void SaveJournal();
+    void Restart();
+    std::optional<uint32_t> CalcTempFileCRC32() const;
+};
@@ -0,0 +1,94 @@
+#include "DownloadScheduler.h"
+#include <algorithm>
+
+bool DownloadScheduler::SetPolicy(DownloadSchedulePolicy policy)
+{
+    if (!empty())
+        return false;
+
+    policy_ = policy;
+    return true;
+}
+
+void DownloadScheduler::Push(QueuedRequest request)
+{
+    queue_.push_back({std::move(request), next_sequence_++});
+    std::push_heap(queue_.begin(), queue_.end(), [this](const Entry& lhs, const Entry& rhs) { return Compare(lhs, rhs); });
+}
+
+void DownloadScheduler::PushRetry(QueuedRequest request, time_point now)
+{
+    time_point ready_time = now + GetRetryDelay(request.get_retry());
+
+    auto it = std::upper_bound(retry_queue_.begin(), retry_queue_.end(), ready_time, [](const time_point& time, const RetryEntry& entry) {
+        return time < entry.ready_time;
+    });
+    retry_queue_.insert(it, {std::move(request), ready_time});
+}
+
+const QueuedRequest* DownloadScheduler::Peek(time_point now) const
+{
+    if (!queue_.empty())
+        return &queue_.front().request;
+
+    if (IsRetryReady(now))
+        return &retry_queue_.front().request;
+
+    return nullptr;
+}
+
+void DownloadScheduler::Pop(time_point now)
+{
+    if (!queue_.empty())
+    {
+        std::pop_heap(queue_.begin(), queue_.end(), [this](const Entry& lhs, const Entry& rhs) { return Compare(lhs, rhs); });
+        queue_.pop_back();
+        return;
+    }
+
+    if (IsRetryReady(now))
+        retry_queue_.pop_front();
+}
+
+void DownloadScheduler::Clear()
+{
+    queue_.clear();
+    retry_queue_.clear();
+    next_sequence_ = 0;
+}
+
+bool DownloadScheduler::IsRetryReady(time_point now) const
+{
+    return !retry_queue_.empty() && retry_queue_.front().ready_time <= now;
+}
+
+std::chrono::milliseconds DownloadScheduler::GetRetryDelay(int retry) const
+{
+    int shift = std::clamp(retry - 1, 0, 16);
+    return std::min(retry_base_delay_ * (1 << shift), retry_max_delay_);
+}
+
+// Returns true if lhs must be started after rhs
+bool DownloadScheduler::Compare(const Entry& lhs, const Entry& rhs) const
+{
+    int lhs_size = lhs.request.get_file_resource().download_size;
+    int rhs_size = rhs.request.get_file_resource().download_size;
+
+    switch (policy_)
+    {
+        case DownloadSchedulePolicy::LargestFirst:
+            if (lhs_size != rhs_size)
+                return lhs_size < rhs_size;
+            break;
+
+        case DownloadSchedulePolicy::SmallestFirst:
+            if (lhs_size != rhs_size)
+                return lhs_size > rhs_size;
+            break;
+
+        case DownloadSchedulePolicy::Fifo:
+            break;
+    }
+
+    return lhs.sequence > rhs.sequence;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <cstdint>
+
+#include "QueuedRequest.hpp"
+
+enum class DownloadSchedulePolicy
+{
+    Fifo = 0,
+    LargestFirst,
+    SmallestFirst,
+};
+
+// Orders queued files by the schedule policy. Failed files are re-queued to a separate retry lane,
+// they become ready after a backoff and are started only when no healthy file is waiting.
+class DownloadScheduler
+{
+public:
+    using time_point = std::chrono::time_point<std::chrono::system_clock>;
+
+private:
+    struct Entry
+    {
+        QueuedRequest request;
+        uint64_t sequence;
+    };
+
+    struct RetryEntry
+    {
+        QueuedRequest request;
+        time_point ready_time;
+    };
+
+    const std::chrono::milliseconds retry_base_delay_ = std::chrono::milliseconds(500);
+    const std::chrono::milliseconds retry_max_delay_ = std::chrono::seconds(8);
+
+    DownloadSchedulePolicy policy_ = DownloadSchedulePolicy::Fifo;
+    std::vector<Entry> queue_;
+    std::deque<RetryEntry> retry_queue_;
+    uint64_t next_sequence_ = 0;
+
+public:
+    // The policy can be changed only when the scheduler is empty
+    bool SetPolicy(DownloadSchedulePolicy policy);
+    [[nodiscard]] DownloadSchedulePolicy get_policy() const { return policy_; }
+
+    void Push(QueuedRequest request);
+    void PushRetry(QueuedRequest request, time_point now);
+
+    // Returns the next request that can be started or nullptr
+    [[nodiscard]] const QueuedRequest* Peek(time_point now) const;
+    // Removes the request returned by Peek
+    void Pop(time_point now);
+
+    void Clear();
+    [[nodiscard]] size_t size() const { return queue_.size() + retry_queue_.size(); }
+    [[nodiscard]] bool empty() const { return queue_.empty() && retry_queue_.empty(); }
+
+private:
+    bool IsRetryReady(time_point now) const;
+    std::chrono::milliseconds GetRetryDelay(int retry) const;
+    bool Compare(const Entry& lhs, const Entry& rhs) const;
+};
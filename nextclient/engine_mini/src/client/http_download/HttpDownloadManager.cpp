@@ -1,6 +1,8 @@
 #include "HttpDownloadManager.h"
 #include "../../engine.h"
 #include "../../console/console.h"
+#include "../../utils/TaskRun.h"
+#include <metaaudio.h>
 #include <nitro_utils/string_utils.h>
 #include <filesystem>
 #include <format>
@@ -21,18 +23,42 @@ HttpDownloadManager::HttpDownloadManager(IGameUI* game_ui,
 {
     cvar_max_active_requests = gEngfuncs.pfnRegisterVariable("http_max_active_requests", "5", FCVAR_ARCHIVE);
     cvar_max_requests_retries = gEngfuncs.pfnRegisterVariable("http_max_requests_retries", "3", FCVAR_ARCHIVE);
+    cvar_max_active_bytes = gEngfuncs.pfnRegisterVariable("http_max_active_bytes", "2097152", FCVAR_ARCHIVE);
+    // 0 - in order of the resource list, 1 - largest files first, 2 - smallest files first
+    cvar_download_order = gEngfuncs.pfnRegisterVariable("http_download_order", "1", FCVAR_ARCHIVE);
+    // 1 - request <file>.zst and <file>.gz stored next to the files on the host before the file itself
+    cvar_precompressed = gEngfuncs.pfnRegisterVariable("http_precompressed", "1", FCVAR_ARCHIVE);
 
     requests_.reserve(MAX_POSSIBLE_ACTIVE_REQUESTS);
+    transfer_pool_ = std::make_unique<HttpTransferPool>(GetMaxActiveRequests());
 }
 
+// Also limits the number of connections per host
 int HttpDownloadManager::GetMaxActiveRequests() {
-    return clamp(cvar_max_active_requests->value, 1, MAX_POSSIBLE_ACTIVE_REQUESTS);
+    return clamp(cvar_max_active_requests->value, 1, MAX_POSSIBLE_CONNECTIONS);
 }
 
 int HttpDownloadManager::GetMaxRequestsRetries() {
     return clamp(cvar_max_requests_retries->value, 0, 10);
 }
 
+uint32_t HttpDownloadManager::GetMaxActiveBytes() {
+    return clamp(cvar_max_active_bytes->value, 0, 64 * 1024 * 1024);
+}
+
+DownloadSchedulePolicy HttpDownloadManager::GetDownloadOrder() {
+    return (DownloadSchedulePolicy)clamp(cvar_download_order->value, (int)DownloadSchedulePolicy::Fifo, (int)DownloadSchedulePolicy::SmallestFirst);
+}
+
+PrecompressedEncoding HttpDownloadManager::GetPrecompressedEncoding(const QueuedRequest& queued_request, const DownloadFileStream& file_stream)
+{
+    // a partial file is continued from the original file
+    if (cvar_precompressed->value == 0 || file_stream.get_resume_offset() > 0)
+        return PrecompressedEncoding::None;
+
+    return queued_request.get_encoding().value_or(host_encoding_);
+}
+
 void HttpDownloadManager::SetUrl(const std::string &url)
 {
     if (!ValidateUrl(url))
@@ -42,7 +68,14 @@ void HttpDownloadManager::SetUrl(const std::string &url)
         return;
     }
 
-    base_url_ = FixUrl(url);
+    std::string base_url = FixUrl(url);
+    if (base_url != base_url_)
+    {
+        host_encoding_ = PrecompressedEncoding::Zstd;
+        is_host_encoding_confirmed_ = false;
+    }
+
+    base_url_ = std::move(base_url);
 }
 
 void HttpDownloadManager::Queue(const resource_descriptor_t& file_resource)
@@ -64,12 +97,15 @@ void HttpDownloadManager::Queue(const resource_descriptor_t& file_resource)
     total_bytes_to_download_ += file_resource.download_size;
     total_files_to_download_++;
 
-    files_to_download_.emplace(file_resource, 0);
+    if (files_to_download_.empty())
+        files_to_download_.SetPolicy(GetDownloadOrder());
+
+    files_to_download_.Push(QueuedRequest(file_resource, 0));
 }
 
 void HttpDownloadManager::Stop()
 {
-    std::queue<QueuedRequest>().swap(files_to_download_);
+    files_to_download_.Clear();
 
     for (const auto &request : requests_)
     {
@@ -77,6 +113,10 @@ void HttpDownloadManager::Stop()
     }
     requests_.clear();
 
+    // results of the requests being finalized are ignored
+    (*session_id_)++;
+    finalizing_requests_count_ = 0;
+
     if (is_download_active_)
         InvokeEndDownloadingEvent();
 
@@ -85,16 +125,19 @@ void HttpDownloadManager::Stop()
     total_files_to_download_ = 0;
     total_bytes_to_download_ = 0;
     completed_requests_bytes_downloaded_ = 0;
+    completed_requests_payload_bytes_ = 0;
     is_slow_speed_ = false;
 }
 
 uint32_t HttpDownloadManager::GetDownloadQueueSize()
 {
-    return files_to_download_.size() + requests_.size();
+    return files_to_download_.size() + requests_.size() + finalizing_requests_count_;
 }
 
 void HttpDownloadManager::Update()
 {
+    transfer_pool_->SetMaxHostConnections(GetMaxActiveRequests());
+
     PruneCompletedRequests();
     StartNewDownloads();
     UpdateDownloadSpeed();
@@ -145,87 +188,247 @@ void HttpDownloadManager::PruneCompletedRequests()
             continue;
         }
 
-        auto response_result = request.get_response().get();
-        auto error_message = ValidateResponseAndGetErrorMessage(response_result);
-        const resource_descriptor_t& resource_descriptor = request.get_file_resource();
+        FinalizedRequest finalized_request{request.get_file_resource(), request.get_retry(), request.get_response().get()};
 
-        if (!error_message)
+        DownloadDecoder* decoder = request.get_shared_data()->decoder.get();
+        if (decoder != nullptr)
+            finalized_request.encoding = decoder->get_encoding();
+
+        if (finalized_request.response.error_code == CURLE_OK)
         {
-            bool is_saved = ResDesc_SaveToFile(resource_descriptor, response_result.text.data(), response_result.text.length());
-            if (is_saved)
-            {
-                download_logger_->AddLogFile(resource_descriptor.download_path.c_str(), response_result.downloaded_bytes, LogFileType::FileDownloaded);
-            }
-            else
-            {
-                Con_Printf("[HTTP] Can't save file: %s\n", resource_descriptor.save_path.c_str());
-                download_logger_->AddLogFileError(resource_descriptor.download_path.c_str(), LogFileTypeError::FileSaveError, 0, 0);
-            }
+            completed_requests_bytes_downloaded_ += finalized_request.response.downloaded_bytes;
+            completed_requests_payload_bytes_ += request.get_shared_data()->payload_now;
+        }
 
-            completed_requests_bytes_downloaded_ += response_result.downloaded_bytes;
+        finalizing_requests_count_++;
 
+        if (!TaskRun::IsInitialized())
+        {
+            FinalizeRequest(finalized_request, *request.get_shared_data()->file_stream, decoder, invalid_file_content_.get());
+            OnRequestFinalized(finalized_request);
+            it = requests_.erase(it);
+            continue;
         }
-        else
+
+        // validation and moving the file to its place are done on the thread pool,
+        // the result is handled on the main thread with the session check, since the download may be stopped meanwhile.
+        // finalized_request is copied, it's finalized here if the task can't be started
+        auto result = TaskRun::RunInBackground([
+            shared_data = request.get_shared_data(),
+            invalid_file_content = invalid_file_content_,
+            session_id = std::weak_ptr<uint32_t>(session_id_),
+            expected_session_id = *session_id_,
+            finalized_request,
+            this]() mutable
         {
-            if (request.get_retry() <= GetMaxRequestsRetries())
-            {
-                files_to_download_.emplace(resource_descriptor, request.get_retry() + 1);
-            }
-            else
+            FinalizeRequest(finalized_request, *shared_data->file_stream, shared_data->decoder.get(), invalid_file_content.get());
+
+            if (!TaskRun::IsInitialized())
+                return;
+
+            TaskRun::RunInMainThread([session_id, expected_session_id, finalized_request = std::move(finalized_request), this]()
             {
-                total_bytes_to_download_ -= resource_descriptor.download_size;
+                auto current_session_id = session_id.lock();
+                if (current_session_id == nullptr || *current_session_id != expected_session_id)
+                {
+                    // the file is replaced even if the download was stopped meanwhile
+                    if (finalized_request.is_saved)
+                        ResDesc_UpdateFileCRC32(finalized_request.file_resource, finalized_request.crc32);
 
-                Con_Printf("[HTTP] Can't download: %s | %s\n", resource_descriptor.download_path.c_str(), error_message->c_str());
+                    return;
+                }
 
-                auto log_file_type = response_result.status_code == 404 ? LogFileTypeError::FileMissingHTTP : LogFileTypeError::FileErrorHTTP;
-                download_logger_->AddLogFileError(resource_descriptor.download_path.c_str(), log_file_type, (int)response_result.error.code, response_result.status_code);
-            }
+                OnRequestFinalized(finalized_request);
+            });
+        });
+
+        if (result.has_error())
+        {
+            Con_DPrintf(ConLogType::Info, "[HTTP] Can't finalize request in background: %s\n", result.get_error().c_str());
+
+            FinalizeRequest(finalized_request, *request.get_shared_data()->file_stream, decoder, invalid_file_content_.get());
+            OnRequestFinalized(finalized_request);
         }
 
         it = requests_.erase(it);
     }
 }
 
+void HttpDownloadManager::FinalizeRequest(FinalizedRequest& finalized_request, DownloadFileStream& file_stream, const DownloadDecoder* decoder, const std::vector<std::string>* invalid_file_content)
+{
+    const auto& response = finalized_request.response;
+
+    finalized_request.error_message = ValidateResponseAndGetErrorMessage(response, file_stream, decoder, invalid_file_content);
+    if (!finalized_request.error_message)
+    {
+        finalized_request.is_saved = file_stream.Commit();
+        finalized_request.crc32 = file_stream.get_crc32();
+    }
+    else
+    {
+        // keep the partial file if the transfer was interrupted, the retry will continue it,
+        // the decoded part of a pre-compressed file is not kept since its stream is not resumable
+        if (response.error_code != CURLE_OK)
+            file_stream.Suspend();
+        else
+            file_stream.Discard();
+
+        // static hosts often answer a missing file with an error page, which is not compressed data
+        finalized_request.is_precompressed_missing = decoder != nullptr && (response.status_code == 404 || decoder->is_failed());
+    }
+}
+
+void HttpDownloadManager::OnRequestFinalized(const FinalizedRequest& finalized_request)
+{
+    const resource_descriptor_t& resource_descriptor = finalized_request.file_resource;
+    const HttpTransferResult& response_result = finalized_request.response;
+
+    finalizing_requests_count_--;
+
+    if (!finalized_request.error_message)
+    {
+        if (finalized_request.encoding != PrecompressedEncoding::None && !is_host_encoding_confirmed_)
+        {
+            host_encoding_ = finalized_request.encoding;
+            is_host_encoding_confirmed_ = true;
+        }
+
+        if (finalized_request.is_saved)
+        {
+            // the resource index is used by the main thread only
+            ResDesc_UpdateFileCRC32(resource_descriptor, finalized_request.crc32);
+            download_logger_->AddLogFile(resource_descriptor.download_path.c_str(), response_result.downloaded_bytes, LogFileType::FileDownloaded);
+            S_OnFileDownloaded(resource_descriptor.filename.c_str());
+        }
+        else
+        {
+            Con_Printf("[HTTP] Can't save file: %s\n", resource_descriptor.save_path.c_str());
+            download_logger_->AddLogFileError(resource_descriptor.download_path.c_str(), LogFileTypeError::FileSaveError, 0, 0);
+        }
+    }
+    else if (finalized_request.is_precompressed_missing)
+    {
+        PrecompressedEncoding next_encoding = finalized_request.encoding == PrecompressedEncoding::Zstd ? PrecompressedEncoding::Gzip : PrecompressedEncoding::None;
+
+        // the next files don't look for the files of this encoding until one of them is found on the host
+        if (!is_host_encoding_confirmed_ && host_encoding_ == finalized_request.encoding)
+            host_encoding_ = next_encoding;
+
+        files_to_download_.Push(QueuedRequest(resource_descriptor, finalized_request.retry, next_encoding));
+    }
+    else
+    {
+        if (finalized_request.retry <= GetMaxRequestsRetries())
+        {
+            files_to_download_.PushRetry(QueuedRequest(resource_descriptor, finalized_request.retry + 1), system_clock::now());
+        }
+        else
+        {
+            total_bytes_to_download_ -= resource_descriptor.download_size;
+
+            Con_Printf("[HTTP] Can't download: %s | %s\n", resource_descriptor.download_path.c_str(), finalized_request.error_message->c_str());
+
+            auto log_file_type = response_result.status_code == 404 ? LogFileTypeError::FileMissingHTTP : LogFileTypeError::FileErrorHTTP;
+            download_logger_->AddLogFileError(resource_descriptor.download_path.c_str(), log_file_type, (int)response_result.error_code, response_result.status_code);
+        }
+    }
+}
+
 void HttpDownloadManager::StartNewDownloads()
 {
-    while (!files_to_download_.empty())
+    auto now = system_clock::now();
+
+    while (const QueuedRequest* next_request = files_to_download_.Peek(now))
     {
-        if (requests_.size() >= GetMaxActiveRequests())
+        const QueuedRequest& queued_request = *next_request;
+        if (!CanStartNewRequest(queued_request))
             break;
 
-        auto& queued_request = files_to_download_.front();
-
         std::string file_url = base_url_ + queued_request.get_file_resource().download_path;
         nitro_utils::replace_all(file_url, " ", "%20");
 
         auto shared_data = std::make_shared<RequestContext::Shared>();
-        auto cpr_response = cpr::GetAsync(
-            cpr::Url(file_url),
-            cpr::UserAgent("Valve/Steam HTTP Client 1.0 (10)"),
-            cpr::ConnectTimeout(std::chrono::duration_cast<std::chrono::milliseconds>(connection_timeout_)),
-            cpr::ProgressCallback(
-                [shared_data]
-                    (size_t downloadTotal, size_t downloadNow, size_t uploadTotal, size_t uploadNow, intptr_t userdata)
-                {
-                    if (shared_data->stop_download)
-                        return false;
+        shared_data->file_stream = std::make_unique<DownloadFileStream>(queued_request.get_file_resource().save_path, MAX_VALIDATED_DATA_SIZE + 1);
+        shared_data->file_stream->Open();
+
+        PrecompressedEncoding encoding = GetPrecompressedEncoding(queued_request, *shared_data->file_stream);
+        if (encoding != PrecompressedEncoding::None)
+        {
+            shared_data->decoder = std::make_unique<DownloadDecoder>(encoding);
+            // the decoded part has no validator of the original file
+            shared_data->file_stream->set_resumable(false);
+        }
+
+        HttpTransferOptions options;
+        options.url = file_url + DownloadDecoder::GetExtension(encoding);
+        options.user_agent = "Valve/Steam HTTP Client 1.0 (10)";
+        options.connect_timeout = std::chrono::duration_cast<std::chrono::milliseconds>(connection_timeout_);
+
+        if (shared_data->file_stream->get_resume_offset() > 0)
+        {
+            options.headers.emplace_back(std::format("Range: bytes={}-", shared_data->file_stream->get_resume_offset()));
+            options.headers.emplace_back(std::format("If-Range: {}", shared_data->file_stream->get_validator()));
+        }
+        else if (encoding == PrecompressedEncoding::None)
+        {
+            // byte ranges of an encoded response don't match the decoded file, so encodings are used only for whole files,
+            // the pre-compressed files are decoded by the decoder and must be received as they are
+            options.accept_encoding = "";
+        }
+
+        options.progress_callback = [shared_data](size_t download_total, size_t download_now)
+        {
+            if (shared_data->stop_download)
+                return false;
+
+            shared_data->download_total = download_total;
+            shared_data->download_now = download_now;
+
+            return true;
+        };
+        options.header_callback = [shared_data](std::string_view header)
+        {
+            shared_data->file_stream->OnHeader(header);
+            return true;
+        };
+        options.write_callback = [shared_data](std::string_view data)
+        {
+            if (shared_data->stop_download)
+                return false;
+
+            auto write = [&shared_data](std::string_view decoded_data)
+            {
+                if (!shared_data->file_stream->Write(decoded_data))
+                    return false;
+
+                shared_data->payload_now += (uint32_t)decoded_data.size();
+                return true;
+            };
+
+            if (shared_data->decoder)
+                return shared_data->decoder->Decode(data, write);
 
-                    shared_data->download_total = downloadTotal;
-                    shared_data->download_now = downloadNow;
+            return write(data);
+        };
 
-                    return true;
-                }));
+        auto response = transfer_pool_->Perform(std::move(options));
         requests_.emplace_back(
             queued_request.get_file_resource(),
             queued_request.get_retry(),
             std::chrono::system_clock::now(),
             shared_data,
-            std::move(cpr_response));
+            std::move(response));
 
-        files_to_download_.pop();
+        files_to_download_.Pop(now);
 
         if (!is_download_active_)
         {
+            auto invalid_file_content = config_provider_->get_list("invalid_file_content");
+            if (invalid_file_content)
+                invalid_file_content_ = std::make_shared<const std::vector<std::string>>(invalid_file_content->cbegin(), invalid_file_content->cend());
+            else
+                invalid_file_content_ = nullptr;
+
             is_download_active_ = true;
             Con_Printf("[HTTP] Start downloading from: %s\n", base_url_.c_str());
             InvokeStartDownloadingEvent();
@@ -295,7 +498,8 @@ void HttpDownloadManager::UpdateUi()
             char downloading_files[64];
             localize_->ConvertUnicodeToANSI(localize_->Find("#NextClient_Downloading_Files"), downloading_files, sizeof(downloading_files));
 
-            uint32_t actual_bytes_downloaded = GetDownloadedBytes();
+            // the progress is in the size of the files, the speed is in the received bytes
+            uint32_t actual_bytes_downloaded = GetPayloadBytes();
 
             status_str.append(downloading_files);
             status_str.append(" ");
@@ -327,6 +531,10 @@ void HttpDownloadManager::CheckAllDownloadsCompleted()
 {
     if (is_download_active_ && GetDownloadQueueSize() == 0)
     {
+        Con_Printf("[HTTP] Downloaded %s, received %s\n",
+                   FormatFileSize(completed_requests_payload_bytes_, 2).c_str(),
+                   FormatFileSize(completed_requests_bytes_downloaded_, 2).c_str());
+
         Stop();
         gEngfuncs.pfnClientCmd("retry");
     }
@@ -348,6 +556,49 @@ uint32_t HttpDownloadManager::GetDownloadedBytes()
     return actual_bytes_downloaded;
 }
 
+uint32_t HttpDownloadManager::GetPayloadBytes()
+{
+    uint32_t active_downloads_bytes = std::accumulate(
+        requests_.cbegin(),
+        requests_.cend(),
+        0,
+        [](uint32_t sum, const auto &request)
+        {
+            return sum + request.get_shared_data()->payload_now;
+        });
+
+    return completed_requests_payload_bytes_ + active_downloads_bytes;
+}
+
+uint32_t HttpDownloadManager::GetActiveRequestsRemainingBytes()
+{
+    return std::accumulate(
+        requests_.cbegin(),
+        requests_.cend(),
+        0,
+        [](uint32_t sum, const auto &request)
+        {
+            uint32_t download_size = request.get_file_resource().download_size;
+            uint32_t payload_now = request.get_shared_data()->payload_now;
+
+            return sum + (download_size > payload_now ? download_size - payload_now : 0);
+        });
+}
+
+bool HttpDownloadManager::CanStartNewRequest(const QueuedRequest& queued_request)
+{
+    if (requests_.size() >= MAX_POSSIBLE_ACTIVE_REQUESTS)
+        return false;
+
+    if (requests_.size() < GetMaxActiveRequests())
+        return true;
+
+    // all connections are busy, keep adding requests while the bytes in flight are below the limit,
+    // so many small files share the connections and one large file doesn't take the whole budget
+    uint32_t download_size = std::max(queued_request.get_file_resource().download_size, 0);
+    return GetActiveRequestsRemainingBytes() + download_size <= GetMaxActiveBytes();
+}
+
 std::string HttpDownloadManager::FormatFileSize(size_t size, short precision)
 {
     std::ostringstream stringSize;
@@ -384,33 +635,38 @@ std::string HttpDownloadManager::FixUrl(const std::string &url)
     return fixed_url;
 }
 
-std::optional<std::string> HttpDownloadManager::ValidateResponseAndGetErrorMessage(const cpr::Response& response)
+std::optional<std::string> HttpDownloadManager::ValidateResponseAndGetErrorMessage(const HttpTransferResult& response, const DownloadFileStream& file_stream, const DownloadDecoder* decoder, const std::vector<std::string>* invalid_file_content)
 {
-    if (response.error.code != cpr::ErrorCode::OK)
-        return response.error.message;
+    if (response.error_code != CURLE_OK)
+        return response.error_message;
 
-    if (response.status_code != 200)
+    bool is_status_ok = response.status_code == 200 || (response.status_code == 206 && file_stream.is_resumed());
+    if (!is_status_ok || file_stream.is_failed())
         return "HTTP Code: " + std::to_string(response.status_code);
 
-    if (response.text.empty())
+    if (decoder != nullptr && (decoder->is_failed() || !decoder->is_finished()))
+        return "Invalid compressed data";
+
+    if (file_stream.get_written_bytes() == 0)
         return "Empty file";
 
-    if (!ValidateDownloadedData(response.text))
+    // only the head of the file is kept in memory, it's enough since large files are not validated,
+    // resumed files are always large enough
+    if (!file_stream.is_resumed() && !ValidateDownloadedData(file_stream.get_head(), invalid_file_content))
         return "Invalid downloaded data";
 
     return {};
 }
 
-bool HttpDownloadManager::ValidateDownloadedData(const std::string &data)
+bool HttpDownloadManager::ValidateDownloadedData(const std::string &data, const std::vector<std::string>* invalid_file_content)
 {
-    if (data.size() > 2048)
+    if (data.size() > MAX_VALIDATED_DATA_SIZE)
         return true;
 
-    auto bad_content = config_provider_->get_list("invalid_file_content");
-    if (!bad_content)
+    if (invalid_file_content == nullptr)
         return true;
 
-    for (const auto &bad_str : *bad_content)
+    for (const auto &bad_str : *invalid_file_content)
     {
         if (data.find(bad_str) != std::string::npos)
             return false;
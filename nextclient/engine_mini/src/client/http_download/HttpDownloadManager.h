@@ -5,8 +5,6 @@
 #include <future>
 #include <chrono>
 
-#include <cpr/api.h>
-
 #include <next_engine_mini/HttpDownloadManagerInterface.h>
 #include <next_engine_mini//DownloadFileLoggerInterface.h>
 #include <nitro_utils/config_utils.h>
@@ -16,16 +14,39 @@
 #include "TransferStatistics.h"
 #include "RequestContext.hpp"
 #include "QueuedRequest.hpp"
+#include "HttpTransferPool.h"
+#include "DownloadScheduler.h"
 #include "../../resource_descriptor.h"
 
 class HttpDownloadManager : public HttpDownloadManagerInterface
 {
     using time_point = std::chrono::time_point<std::chrono::system_clock>;
 
-    const int MAX_POSSIBLE_ACTIVE_REQUESTS = 30;
+    // small files are multiplexed over the opened connections, so there may be more requests than connections
+    const int MAX_POSSIBLE_ACTIVE_REQUESTS = 64;
+    const int MAX_POSSIBLE_CONNECTIONS = 30;
+    // files larger than this are not checked for invalid content
+    static constexpr size_t MAX_VALIDATED_DATA_SIZE = 2048;
+
+    struct FinalizedRequest
+    {
+        resource_descriptor_t file_resource;
+        int retry;
+        HttpTransferResult response;
+        std::optional<std::string> error_message{};
+        bool is_saved = false;
+        // crc32 of the saved file
+        std::optional<CRC32_t> crc32{};
+        PrecompressedEncoding encoding = PrecompressedEncoding::None;
+        // the host has no such pre-compressed file, the next one is requested without counting a retry
+        bool is_precompressed_missing = false;
+    };
 
     cvar_t* cvar_max_active_requests;
     cvar_t* cvar_max_requests_retries;
+    cvar_t* cvar_max_active_bytes;
+    cvar_t* cvar_download_order;
+    cvar_t* cvar_precompressed;
 
     const uint32_t slow_speed_threshold_ = 1024 * 30; // bytes per sec
     const std::chrono::seconds connection_timeout_ = std::chrono::seconds(7);
@@ -41,16 +62,29 @@ class HttpDownloadManager : public HttpDownloadManagerInterface
     std::vector<HttpDownloadManagerEventsListenerInterface*> listeners_;
 
     std::string base_url_;
+    // the pre-compressed files requested for the new files, changed to the next encoding while
+    // the host has none of them, and kept once a file of the host is received in this encoding
+    PrecompressedEncoding host_encoding_ = PrecompressedEncoding::Zstd;
+    bool is_host_encoding_confirmed_ = false;
+
+    std::unique_ptr<HttpTransferPool> transfer_pool_;
 
-    std::queue<QueuedRequest> files_to_download_;
+    DownloadScheduler files_to_download_;
     std::vector<RequestContext> requests_;
+    uint32_t finalizing_requests_count_ = 0;
+    // incremented on Stop to drop the results of the requests finalized on the thread pool
+    std::shared_ptr<uint32_t> session_id_ = std::make_shared<uint32_t>(0);
+    std::shared_ptr<const std::vector<std::string>> invalid_file_content_;
 
     bool is_download_active_ = false;
     bool is_slow_speed_ = false;
     time_point slow_speed_start_time_{};
     uint32_t total_files_to_download_ = 0;
     uint32_t total_bytes_to_download_ = 0;
+    // received bytes, the compressed size for the compressed responses
     uint32_t completed_requests_bytes_downloaded_ = 0;
+    // bytes written to the files
+    uint32_t completed_requests_payload_bytes_ = 0;
 
     TransferStatistics<uint32_t> download_statistics_;
     time_point bytes_downloaded_prev_time_{};
@@ -74,18 +108,27 @@ private:
     void InvokeStartDownloadingEvent();
     void InvokeEndDownloadingEvent();
     void PruneCompletedRequests();
+    void OnRequestFinalized(const FinalizedRequest& finalized_request);
     void StartNewDownloads();
     void UpdateUi();
     void UpdateDownloadSpeed();
     void SlowSpeedDetection();
     void CheckAllDownloadsCompleted();
     uint32_t GetDownloadedBytes();
+    uint32_t GetPayloadBytes();
+    uint32_t GetActiveRequestsRemainingBytes();
+    bool CanStartNewRequest(const QueuedRequest& queued_request);
 
     int GetMaxActiveRequests();
     int GetMaxRequestsRetries();
-
-    std::optional<std::string> ValidateResponseAndGetErrorMessage(const cpr::Response& response);
-    bool ValidateDownloadedData(const std::string &data);
+    uint32_t GetMaxActiveBytes();
+    DownloadSchedulePolicy GetDownloadOrder();
+    PrecompressedEncoding GetPrecompressedEncoding(const QueuedRequest& queued_request, const DownloadFileStream& file_stream);
+
+    // called from the thread pool
+    static void FinalizeRequest(FinalizedRequest& finalized_request, DownloadFileStream& file_stream, const DownloadDecoder* decoder, const std::vector<std::string>* invalid_file_content);
+    static std::optional<std::string> ValidateResponseAndGetErrorMessage(const HttpTransferResult& response, const DownloadFileStream& file_stream, const DownloadDecoder* decoder, const std::vector<std::string>* invalid_file_content);
+    static bool ValidateDownloadedData(const std::string &data, const std::vector<std::string>* invalid_file_content);
 
 public:
     static std::string FormatFileSize(size_t size, short precision);
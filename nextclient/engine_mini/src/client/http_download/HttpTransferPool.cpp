@@ -0,0 +1,235 @@
+#include "HttpTransferPool.h"
+#include <algorithm>
+
+HttpTransferPool::HttpTransferPool(long max_host_connections) :
+    max_host_connections_(max_host_connections)
+{
+    curl_version_info_data* version_info = curl_version_info(CURLVERSION_NOW);
+    is_http2_supported_ = version_info != nullptr && (version_info->features & CURL_VERSION_HTTP2) != 0;
+
+    multi_ = curl_multi_init();
+    curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, max_host_connections);
+
+    thread_ = std::thread(&HttpTransferPool::ThreadMain, this);
+}
+
+HttpTransferPool::~HttpTransferPool()
+{
+    shutdown_requested_ = true;
+    curl_multi_wakeup(multi_);
+
+    if (thread_.joinable())
+        thread_.join();
+
+    curl_multi_cleanup(multi_);
+}
+
+std::future<HttpTransferResult> HttpTransferPool::Perform(HttpTransferOptions&& options)
+{
+    auto transfer = std::make_unique<Transfer>();
+    transfer->options = std::move(options);
+    auto future = transfer->promise.get_future();
+
+    {
+        std::lock_guard lock(pending_mutex_);
+        pending_transfers_.emplace_back(std::move(transfer));
+    }
+
+    curl_multi_wakeup(multi_);
+    return future;
+}
+
+void HttpTransferPool::SetMaxHostConnections(long max_host_connections)
+{
+    if (max_host_connections_.exchange(max_host_connections) != max_host_connections)
+        curl_multi_wakeup(multi_);
+}
+
+void HttpTransferPool::ThreadMain()
+{
+    long applied_max_host_connections = max_host_connections_;
+
+    while (!shutdown_requested_)
+    {
+        if (applied_max_host_connections != max_host_connections_)
+        {
+            applied_max_host_connections = max_host_connections_;
+            curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, applied_max_host_connections);
+        }
+
+        StartPendingTransfers();
+
+        int running_handles = 0;
+        curl_multi_perform(multi_, &running_handles);
+
+        FinishCompletedTransfers();
+
+        // sleeps until a socket is ready, a timeout of curl expires or Perform wakes the thread up
+        curl_multi_poll(multi_, nullptr, 0, 1000, nullptr);
+    }
+
+    AbortAllTransfers();
+}
+
+void HttpTransferPool::StartPendingTransfers()
+{
+    std::deque<std::unique_ptr<Transfer>> transfers;
+    {
+        std::lock_guard lock(pending_mutex_);
+        transfers.swap(pending_transfers_);
+    }
+
+    for (auto& transfer : transfers)
+    {
+        if (!SetupTransfer(*transfer))
+        {
+            HttpTransferResult result;
+            result.error_code = CURLE_FAILED_INIT;
+            result.error_message = "Can't initialize transfer";
+            transfer->promise.set_value(std::move(result));
+
+            if (transfer->easy != nullptr)
+                curl_easy_cleanup(transfer->easy);
+            curl_slist_free_all(transfer->headers);
+            continue;
+        }
+
+        curl_multi_add_handle(multi_, transfer->easy);
+        active_transfers_.emplace_back(std::move(transfer));
+    }
+}
+
+void HttpTransferPool::FinishCompletedTransfers()
+{
+    CURLMsg* message;
+    int messages_left;
+
+    while ((message = curl_multi_info_read(multi_, &messages_left)) != nullptr)
+    {
+        if (message->msg != CURLMSG_DONE)
+            continue;
+
+        auto it = std::find_if(active_transfers_.begin(), active_transfers_.end(), [message](const auto& transfer) {
+            return transfer->easy == message->easy_handle;
+        });
+        if (it == active_transfers_.end())
+            continue;
+
+        auto& transfer = *it;
+
+        HttpTransferResult result;
+        result.error_code = message->data.result;
+        if (result.error_code != CURLE_OK)
+            result.error_message = transfer->error_buffer[0] != '\0' ? transfer->error_buffer : curl_easy_strerror(result.error_code);
+
+        curl_off_t downloaded_bytes = 0;
+        curl_easy_getinfo(transfer->easy, CURLINFO_RESPONSE_CODE, &result.status_code);
+        curl_easy_getinfo(transfer->easy, CURLINFO_SIZE_DOWNLOAD_T, &downloaded_bytes);
+        result.downloaded_bytes = (size_t)downloaded_bytes;
+
+        curl_multi_remove_handle(multi_, transfer->easy);
+        curl_easy_cleanup(transfer->easy);
+        curl_slist_free_all(transfer->headers);
+
+        transfer->promise.set_value(std::move(result));
+        active_transfers_.erase(it);
+    }
+}
+
+void HttpTransferPool::AbortAllTransfers()
+{
+    StartPendingTransfers();
+
+    for (auto& transfer : active_transfers_)
+    {
+        curl_multi_remove_handle(multi_, transfer->easy);
+        curl_easy_cleanup(transfer->easy);
+        curl_slist_free_all(transfer->headers);
+
+        HttpTransferResult result;
+        result.error_code = CURLE_ABORTED_BY_CALLBACK;
+        result.error_message = "Transfer pool is shut down";
+        transfer->promise.set_value(std::move(result));
+    }
+
+    active_transfers_.clear();
+}
+
+bool HttpTransferPool::SetupTransfer(Transfer& transfer)
+{
+    transfer.easy = curl_easy_init();
+    if (transfer.easy == nullptr)
+        return false;
+
+    const auto& options = transfer.options;
+
+    for (const auto& header : options.headers)
+        transfer.headers = curl_slist_append(transfer.headers, header.c_str());
+
+    CURL* easy = transfer.easy;
+    curl_easy_setopt(easy, CURLOPT_URL, options.url.c_str());
+    curl_easy_setopt(easy, CURLOPT_USERAGENT, options.user_agent.c_str());
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer.headers);
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, (long)options.connect_timeout.count());
+    curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, transfer.error_buffer);
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(easy, CURLOPT_MAXREDIRS, 50L);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+
+    // load certs from the Windows cert store when using OpenSSL, same as cpr does
+    curl_easy_setopt(easy, CURLOPT_SSL_OPTIONS, (long)CURLSSLOPT_NATIVE_CA);
+
+    if (options.accept_encoding)
+        curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, options.accept_encoding->c_str());
+
+    if (is_http2_supported_)
+    {
+        curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+        // prefer waiting for a connection that can be multiplexed over opening a new one
+        curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+    }
+
+    curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, HeaderFunction);
+    curl_easy_setopt(easy, CURLOPT_HEADERDATA, &transfer);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, WriteFunction);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer);
+    curl_easy_setopt(easy, CURLOPT_XFERINFOFUNCTION, ProgressFunction);
+    curl_easy_setopt(easy, CURLOPT_XFERINFODATA, &transfer);
+    curl_easy_setopt(easy, CURLOPT_NOPROGRESS, 0L);
+
+    return true;
+}
+
+size_t HttpTransferPool::HeaderFunction(char* buffer, size_t size, size_t count, void* userdata)
+{
+    auto transfer = (Transfer*)userdata;
+    size_t length = size * count;
+
+    if (transfer->options.header_callback && !transfer->options.header_callback(std::string_view(buffer, length)))
+        return 0;
+
+    return length;
+}
+
+size_t HttpTransferPool::WriteFunction(char* buffer, size_t size, size_t count, void* userdata)
+{
+    auto transfer = (Transfer*)userdata;
+    size_t length = size * count;
+
+    if (transfer->options.write_callback && !transfer->options.write_callback(std::string_view(buffer, length)))
+        return 0;
+
+    return length;
+}
+
+int HttpTransferPool::ProgressFunction(void* userdata, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow)
+{
+    auto transfer = (Transfer*)userdata;
+
+    if (transfer->options.progress_callback && !transfer->options.progress_callback((size_t)dltotal, (size_t)dlnow))
+        return 1;
+
+    return 0;
+}
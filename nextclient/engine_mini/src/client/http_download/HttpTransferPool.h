@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <future>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <optional>
+
+#include <curl/curl.h>
+
+struct HttpTransferResult
+{
+    CURLcode error_code = CURLE_OK;
+    std::string error_message;
+    long status_code = 0;
+    size_t downloaded_bytes = 0;
+};
+
+struct HttpTransferOptions
+{
+    std::string url;
+    std::string user_agent;
+    std::vector<std::string> headers;
+    std::chrono::milliseconds connect_timeout{};
+    // value for CURLOPT_ACCEPT_ENCODING, an empty string enables all supported encodings
+    std::optional<std::string> accept_encoding;
+
+    // called from the pool thread, returning false aborts the transfer
+    std::function<bool(std::string_view header)> header_callback;
+    std::function<bool(std::string_view data)> write_callback;
+    std::function<bool(size_t download_total, size_t download_now)> progress_callback;
+};
+
+// Runs http transfers on a single curl multi handle driven by a dedicated thread.
+// Connections are kept alive between transfers and shared by all requests to the same host,
+// with HTTP/2 multiplexing negotiated when both libcurl and the server support it.
+class HttpTransferPool
+{
+    struct Transfer
+    {
+        HttpTransferOptions options;
+        std::promise<HttpTransferResult> promise;
+        CURL* easy = nullptr;
+        curl_slist* headers = nullptr;
+        char error_buffer[CURL_ERROR_SIZE]{};
+    };
+
+    CURLM* multi_;
+    std::thread thread_;
+    std::atomic_bool shutdown_requested_ = false;
+
+    std::mutex pending_mutex_;
+    std::deque<std::unique_ptr<Transfer>> pending_transfers_;
+    std::vector<std::unique_ptr<Transfer>> active_transfers_;
+
+    std::atomic_long max_host_connections_;
+    bool is_http2_supported_;
+
+public:
+    explicit HttpTransferPool(long max_host_connections);
+    ~HttpTransferPool();
+    HttpTransferPool(const HttpTransferPool&) = delete;
+    HttpTransferPool& operator=(const HttpTransferPool&) = delete;
+
+    std::future<HttpTransferResult> Perform(HttpTransferOptions&& options);
+    void SetMaxHostConnections(long max_host_connections);
+
+    [[nodiscard]] bool is_http2_supported() const { return is_http2_supported_; }
+
+private:
+    void ThreadMain();
+    void StartPendingTransfers();
+    void FinishCompletedTransfers();
+    void AbortAllTransfers();
+    bool SetupTransfer(Transfer& transfer);
+
+    static size_t HeaderFunction(char* buffer, size_t size, size_t count, void* userdata);
+    static size_t WriteFunction(char* buffer, size_t size, size_t count, void* userdata);
+    static int ProgressFunction(void* userdata, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
+};
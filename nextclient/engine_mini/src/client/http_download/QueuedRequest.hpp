@@ -1,21 +1,27 @@
 #pragma once
 
 #include "../../resource_descriptor.h"
+#include "DownloadDecoder.h"
 #include <string>
 #include <utility>
+#include <optional>
 
 class QueuedRequest
 {
     resource_descriptor_t file_resource_;
     int retry_;
+    // the pre-compressed file to request, the one found on the host if not set
+    std::optional<PrecompressedEncoding> encoding_;
 
 public:
-    QueuedRequest(resource_descriptor_t file_resource, int retry) :
+    QueuedRequest(resource_descriptor_t file_resource, int retry, std::optional<PrecompressedEncoding> encoding = std::nullopt) :
         file_resource_(std::move(file_resource)),
-        retry_(retry)
+        retry_(retry),
+        encoding_(encoding)
     { }
 
     [[nodiscard]] const resource_descriptor_t& get_file_resource() const { return file_resource_; }
     [[nodiscard]] int get_retry() const { return retry_; }
     void set_retry(int retry) { retry_ = retry; }
+    [[nodiscard]] std::optional<PrecompressedEncoding> get_encoding() const { return encoding_; }
 };
\ No newline at end of file
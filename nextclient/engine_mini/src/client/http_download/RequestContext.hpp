@@ -1,7 +1,9 @@
 #pragma once
 
 #include "../../resource_descriptor.h"
-#include <cpr/api.h>
+#include "DownloadFileStream.h"
+#include "DownloadDecoder.h"
+#include "HttpTransferPool.h"
 #include <string>
 #include <queue>
 #include <future>
@@ -16,19 +18,25 @@ public:
     struct Shared
     {
         std::atomic_uint32_t download_total;
+        // received bytes, before decoding
         std::atomic_uint32_t download_now;
+        // bytes written to the file, after decoding
+        std::atomic_uint32_t payload_now;
         std::atomic_bool stop_download = false;
+        std::unique_ptr<DownloadFileStream> file_stream;
+        // null if the original file is requested
+        std::unique_ptr<DownloadDecoder> decoder;
     };
 
 private:
     resource_descriptor_t resource_descriptor;
     int retry_{};
     time_point start_time_;
-    cpr::AsyncResponse response_;
+    std::future<HttpTransferResult> response_;
     std::shared_ptr<Shared> shared_data_;
 
 public:
-    RequestContext(resource_descriptor_t file_resource, int retry, time_point start_time, std::shared_ptr<Shared> shared_data, cpr::AsyncResponse &&response):
+    RequestContext(resource_descriptor_t file_resource, int retry, time_point start_time, std::shared_ptr<Shared> shared_data, std::future<HttpTransferResult> &&response):
             resource_descriptor(std::move(file_resource)),
             retry_(retry),
             start_time_(start_time),
@@ -59,7 +67,7 @@ public:
     }
 
     [[nodiscard]] time_point get_start_time() const { return start_time_; }
-    cpr::AsyncResponse &get_response() { return response_; }
+    std::future<HttpTransferResult> &get_response() { return response_; }
     [[nodiscard]] const resource_descriptor_t& get_file_resource() const { return resource_descriptor; }
     [[nodiscard]] std::shared_ptr<Shared> get_shared_data() const { return shared_data_; }
     [[nodiscard]] int get_retry() const { return retry_; }
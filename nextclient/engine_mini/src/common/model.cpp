@@ -1,8 +1,16 @@
 #include "../engine.h"
 #include <optick.h>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <chrono>
+#include <cctype>
 #include <model.h>
 #include <studio.h>
 #include "model.h"
+#include "model_prefetch.h"
 #include "zone.h"
 #include "sys_dll.h"
 #include "../console/console.h"
@@ -14,6 +22,45 @@ model_t mod_known[MAX_KNOWN_MODELS];
 int mod_numknown;
 mod_known_info_t mod_known_info[MAX_KNOWN_MODELS];
 
+// case-insensitive index of mod_known by name
+struct ModNameHash
+{
+    using is_transparent = void;
+
+    size_t operator()(std::string_view name) const
+    {
+        // FNV-1a
+        size_t hash = 14695981039346656037ull;
+        for (char c : name)
+        {
+            hash ^= (unsigned char)std::tolower((unsigned char)c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+};
+
+struct ModNameEqual
+{
+    using is_transparent = void;
+
+    bool operator()(std::string_view lhs, std::string_view rhs) const
+    {
+        return lhs.size() == rhs.size() && std::equal(lhs.cbegin(), lhs.cend(), rhs.cbegin(), [](char a, char b) {
+            return std::tolower((unsigned char)a) == std::tolower((unsigned char)b);
+        });
+    }
+};
+
+static std::unordered_map<std::string, int, ModNameHash, ModNameEqual> mod_known_index;
+
+// NL_UNREFERENCED slots that can be reused, the slots of alias and studio models are reused last
+// since their data may still be in the cache. A slot may be referenced again by name after it was
+// pushed, so the state is checked when it's popped.
+static std::vector<int> mod_free_slots;
+static std::vector<int> mod_free_cached_slots;
+static bool mod_is_free_slot[MAX_KNOWN_MODELS];
+
 qboolean gSpriteMipMap;
 int gSpriteTextureFormat;
 uint8_t* pspritepal;
@@ -73,49 +120,101 @@ void Mod_FillInCRCInfo(qboolean trackCRC, int model_number)
     p->initialCRC = 0;
 }
 
+static void Mod_IndexName(int model_number)
+{
+    if (mod_known[model_number].name[0])
+        mod_known_index[mod_known[model_number].name] = model_number;
+}
+
+static void Mod_UnindexName(int model_number)
+{
+    auto it = mod_known_index.find(std::string_view(mod_known[model_number].name));
+    if (it != mod_known_index.end() && it->second == model_number)
+        mod_known_index.erase(it);
+}
+
+static void Mod_PushFreeSlot(int model_number)
+{
+    if (mod_is_free_slot[model_number])
+        return;
+
+    model_t* mod = &mod_known[model_number];
+    if (mod->type == mod_alias || mod->type == mod_studio)
+        mod_free_cached_slots.push_back(model_number);
+    else
+        mod_free_slots.push_back(model_number);
+
+    mod_is_free_slot[model_number] = true;
+}
+
+static int Mod_PopFreeSlot(std::vector<int>& slots)
+{
+    while (!slots.empty())
+    {
+        int model_number = slots.back();
+        slots.pop_back();
+        mod_is_free_slot[model_number] = false;
+
+        if (mod_known[model_number].needload == NL_UNREFERENCED)
+            return model_number;
+    }
+
+    return -1;
+}
+
+static void Mod_RebuildIndex()
+{
+    mod_known_index.clear();
+    mod_free_slots.clear();
+    mod_free_cached_slots.clear();
+    Q_memset(mod_is_free_slot, 0, sizeof(mod_is_free_slot));
+
+    for (int i = 0; i < mod_numknown; i++)
+    {
+        Mod_IndexName(i);
+
+        if (mod_known[i].needload == NL_UNREFERENCED)
+            Mod_PushFreeSlot(i);
+    }
+}
+
 model_t* Mod_FindName(qboolean trackCRC, const char* name)
 {
     OPTICK_EVENT();
 
-    model_t* avail;
-    int i;
     model_t* mod;
 
-    avail = NULL;
     if (!name[0])
         Sys_Error("Mod_ForName: NULL name");
 
-    for (i = 0, mod = mod_known; i < mod_numknown; i++, mod++)
-    {
-        if (!Q_stricmp(mod->name, name))
-            break;
+    auto it = mod_known_index.find(std::string_view(name));
+    if (it != mod_known_index.end())
+        return &mod_known[it->second];
 
-        if (mod->needload == NL_UNREFERENCED)
-        {
-            if (!avail || mod->type != mod_alias && mod->type != mod_studio)
-                avail = mod;
-        }
+    if (mod_numknown < MAX_KNOWN_MODELS)
+    {
+        mod = &mod_known[mod_numknown];
+        Mod_FillInCRCInfo(trackCRC, mod_numknown);
+        ++mod_numknown;
     }
-
-    if (i == mod_numknown)
+    else
     {
-        if (mod_numknown < MAX_KNOWN_MODELS)
-        {
-            Mod_FillInCRCInfo(trackCRC, mod_numknown);
-            ++mod_numknown;
-        }
-        else
-        {
-            if (!avail)
-                Sys_Error("mod_numknown >= MAX_KNOWN_MODELS");
-            mod = avail;
-            Mod_FillInCRCInfo(trackCRC, avail - mod_known);
-        }
-        Q_strncpy(mod->name, name, MAX_MODEL_NAME);
+        int avail = Mod_PopFreeSlot(mod_free_slots);
+        if (avail == -1)
+            avail = Mod_PopFreeSlot(mod_free_cached_slots);
+
+        if (avail == -1)
+            Sys_Error("mod_numknown >= MAX_KNOWN_MODELS");
 
-        if (mod->needload != NL_CLIENT)
-            mod->needload = NL_NEEDS_LOADED;
+        Mod_UnindexName(avail);
+        mod = &mod_known[avail];
+        Mod_FillInCRCInfo(trackCRC, avail);
     }
+    Q_strncpy(mod->name, name, MAX_MODEL_NAME);
+    Mod_IndexName(mod - mod_known);
+
+    if (mod->needload != NL_CLIENT)
+        mod->needload = NL_NEEDS_LOADED;
 
     return mod;
 }
@@ -361,11 +460,34 @@ model_t* Mod_LoadModel(model_t* mod, qboolean crash, qboolean trackCRC)
         while (*(++p) == '/');
 
         Q_strncpy(tmpName, p, sizeof(tmpName));
+        Mod_UnindexName(mod - mod_known);
         Q_strncpy(mod->name, tmpName, sizeof(mod->name));
+        Mod_IndexName(mod - mod_known);
     }
 
-    // load the file
-    buf = COM_LoadFileForMe(mod->name, &length);
+    // load the file, it may be already read by the prefetch
+    auto io_start_time = std::chrono::steady_clock::now();
+
+    ModelPrefetchBuffer prefetched;
+    bool is_prefetched = ModPrefetch_Take(mod->name, prefetched);
+    if (is_prefetched)
+    {
+#ifndef SWDS
+        const char* path = mod->name;
+        int usehunk = 5;
+        int* pLength = &length;
+        p_g_engdstAddrs->COM_LoadFile(&path, &usehunk, &pLength);
+#endif
+        buf = prefetched.data.data();
+        length = (int)prefetched.data.size() - 1;
+    }
+    else
+    {
+        buf = COM_LoadFileForMe(mod->name, &length);
+    }
+
+    double io_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - io_start_time).count();
+
     if (!buf)
     {
         if (crash)
@@ -374,14 +496,23 @@ model_t* Mod_LoadModel(model_t* mod, qboolean crash, qboolean trackCRC)
         return nullptr;
     }
 
+    auto parse_start_time = std::chrono::steady_clock::now();
+
     if (trackCRC)
     {
         mod_known_info_t* p = &mod_known_info[mod - mod_known];
         if (p->shouldCRC)
         {
-            g_engfuncs.pfnCRC32_Init(&currentCRC);
-            g_engfuncs.pfnCRC32_ProcessBuffer(&currentCRC, buf, length);
-            currentCRC = g_engfuncs.pfnCRC32_Final(currentCRC);
+            if (is_prefetched)
+            {
+                currentCRC = prefetched.crc32;
+            }
+            else
+            {
+                g_engfuncs.pfnCRC32_Init(&currentCRC);
+                g_engfuncs.pfnCRC32_ProcessBuffer(&currentCRC, buf, length);
+                currentCRC = g_engfuncs.pfnCRC32_Final(currentCRC);
+            }
             if (p->firstCRCDone)
             {
                 if (currentCRC != p->initialCRC)
@@ -422,7 +553,8 @@ model_t* Mod_LoadModel(model_t* mod, qboolean crash, qboolean trackCRC)
         break;
 
         default:
-            Mem_Free(buf);
+            if (!is_prefetched)
+                Mem_Free(buf);
             if (crash)
                 Sys_Error("%s: %s has unknown format\n", __func__, mod->name);
             else
@@ -433,10 +565,31 @@ model_t* Mod_LoadModel(model_t* mod, qboolean crash, qboolean trackCRC)
     if (g_modfuncs.m_pfnModelLoad)
         g_modfuncs.m_pfnModelLoad(mod, buf);
 
-    Mem_Free(buf);
+    if (!is_prefetched)
+        Mem_Free(buf);
+
+    double parse_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - parse_start_time).count();
+    if (is_prefetched)
+        ModPrefetch_AddLoadTiming(mod->name, prefetched.io_time, io_time, parse_time, true);
+    else
+        ModPrefetch_AddLoadTiming(mod->name, io_time, 0, parse_time, false);
+
     return mod;
 }
 
+bool Mod_IsLoaded(const char* name)
+{
+    auto it = mod_known_index.find(std::string_view(name));
+    if (it == mod_known_index.end())
+        return false;
+
+    model_t* mod = &mod_known[it->second];
+    if (mod->type == mod_alias || mod->type == mod_studio)
+        return Cache_Check(&mod->cache) != nullptr;
+
+    return mod->needload == NL_PRESENT || mod->needload == NL_CLIENT;
+}
+
 model_t* Mod_ForName(const char* name, qboolean crash, qboolean trackCRC)
 {
     OPTICK_EVENT();
@@ -522,8 +675,10 @@ void Mod_UnloadFiltered(const std::function<bool(model_t*)>& filter)
             Mod_UnloadSpriteTextures(mod);
         }
 
+        Mod_UnindexName(i);
         Q_memset(mod, 0, sizeof(model_t));
         mod->needload = NL_UNREFERENCED;
+        Mod_PushFreeSlot(i);
 
         p = &mod_known_info[i];
         Q_memset(p, 0, sizeof(mod_known_info_t));
@@ -543,6 +698,7 @@ void Mod_ClearAll()
         if (mod->type != mod_alias && mod->needload != NL_CLIENT)
         {
             mod->needload = NL_UNREFERENCED;
+            Mod_PushFreeSlot(i);
 
             if (mod->type == mod_sprite)
                 mod->cache.data = nullptr;
@@ -573,4 +729,6 @@ void Mod_ChangeGame()
         p->firstCRCDone = FALSE;
         p->initialCRC = 0;
     }
+
+    Mod_RebuildIndex();
 }
@@ -20,6 +20,8 @@ model_t* Mod_FindName(qboolean trackCRC, const char* name);
 qboolean Mod_ValidateCRC(const char* name, CRC32_t crc);
 void Mod_NeedCRC(const char* name, qboolean needCRC);
 model_t* Mod_LoadModel(model_t* mod, qboolean crash, qboolean trackCRC);
+// Returns true if the model is loaded and Mod_LoadModel won't read its file
+bool Mod_IsLoaded(const char* name);
 model_t* Mod_ForName(const char* name, qboolean crash, qboolean trackCRC);
 void Mod_Print();
 void Mod_UnloadSpriteTextures(model_t* pModel);
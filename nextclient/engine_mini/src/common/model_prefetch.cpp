@@ -0,0 +1,289 @@
+#include "../engine.h"
+#include <optick.h>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include "model_prefetch.h"
+#include "filesystem.h"
+#include "../console/console.h"
+#include "../utils/Crc32.h"
+#include "../utils/TaskRun.h"
+
+// the files are read ahead of the parsing until this much memory is used by the buffers
+static constexpr size_t MAX_BUFFERED_BYTES = 64 * 1024 * 1024;
+static constexpr unsigned int MAX_WORKERS = 4;
+
+enum class PrefetchEntryState
+{
+    Pending,
+    Reading,
+    Ready,
+    Failed,
+    Taken
+};
+
+struct PrefetchEntry
+{
+    std::filesystem::path local_path;
+    PrefetchEntryState state = PrefetchEntryState::Pending;
+    ModelPrefetchBuffer buffer;
+};
+
+struct ModelPrefetch
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    // not resized after the workers are started
+    std::vector<PrefetchEntry> entries;
+    std::unordered_map<std::string, size_t> entry_by_name;
+    size_t next_entry = 0;
+    size_t buffered_bytes = 0;
+    bool is_aborted = false;
+};
+
+struct ModelLoadTiming
+{
+    std::string name;
+    double io_time;
+    double wait_time;
+    double parse_time;
+    bool is_prefetched;
+};
+
+static std::shared_ptr<ModelPrefetch> g_ModelPrefetch;
+static std::vector<ModelLoadTiming> g_ModelLoadTimings;
+static bool g_IsModelPrefetchActive;
+
+static std::string NormalizeName(const char* name)
+{
+    std::string result = name;
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    std::replace(result.begin(), result.end(), '\\', '/');
+
+    return result;
+}
+
+static bool ReadFile(const std::filesystem::path& path, ModelPrefetchBuffer& buffer)
+{
+    auto start_time = std::chrono::steady_clock::now();
+
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    std::error_code ec;
+    auto size = (size_t)std::filesystem::file_size(path, ec);
+    if (ec)
+        return false;
+
+    buffer.data.resize(size + 1);
+    if (!file.read((char*)buffer.data.data(), (std::streamsize)size))
+        return false;
+
+    buffer.data[size] = 0;
+    buffer.crc32 = Crc32_Calc(buffer.data.data(), size);
+    buffer.io_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    return true;
+}
+
+static void PrefetchWorker(const std::shared_ptr<ModelPrefetch>& prefetch)
+{
+    std::unique_lock lock(prefetch->mutex);
+
+    while (true)
+    {
+        prefetch->cv.wait(lock, [&prefetch] {
+            return prefetch->is_aborted || prefetch->next_entry >= prefetch->entries.size() || prefetch->buffered_bytes < MAX_BUFFERED_BYTES;
+        });
+
+        if (prefetch->is_aborted || prefetch->next_entry >= prefetch->entries.size())
+            return;
+
+        auto& entry = prefetch->entries[prefetch->next_entry++];
+
+        // the model was already loaded on the main thread
+        if (entry.state != PrefetchEntryState::Pending)
+            continue;
+
+        entry.state = PrefetchEntryState::Reading;
+        lock.unlock();
+
+        ModelPrefetchBuffer buffer;
+        bool is_read = ReadFile(entry.local_path, buffer);
+
+        lock.lock();
+        if (is_read)
+        {
+            prefetch->buffered_bytes += buffer.data.size();
+            entry.buffer = std::move(buffer);
+            entry.state = PrefetchEntryState::Ready;
+        }
+        else
+        {
+            entry.state = PrefetchEntryState::Failed;
+        }
+
+        prefetch->cv.notify_all();
+    }
+}
+
+static void AbortPrefetch()
+{
+    if (g_ModelPrefetch == nullptr)
+        return;
+
+    std::lock_guard lock(g_ModelPrefetch->mutex);
+    g_ModelPrefetch->is_aborted = true;
+
+    // the workers may still hold the prefetch, free the buffers now
+    for (auto& entry : g_ModelPrefetch->entries)
+    {
+        if (entry.state == PrefetchEntryState::Ready)
+            entry.buffer = {};
+    }
+
+    g_ModelPrefetch->cv.notify_all();
+    g_ModelPrefetch = nullptr;
+}
+
+void ModPrefetch_Begin(const std::vector<std::string>& names)
+{
+    OPTICK_EVENT();
+
+    AbortPrefetch();
+
+    g_ModelLoadTimings.clear();
+    g_IsModelPrefetchActive = true;
+
+    if (!TaskRun::IsInitialized())
+        return;
+
+    auto prefetch = std::make_shared<ModelPrefetch>();
+    prefetch->entries.reserve(names.size());
+
+    for (const auto& name : names)
+    {
+        auto normalized_name = NormalizeName(name.c_str());
+        if (prefetch->entry_by_name.contains(normalized_name))
+            continue;
+
+        // the search paths are resolved here since the filesystem isn't used from the other threads
+        char local_path[MAX_PATH];
+        if (!FS_GetLocalPath(name.c_str(), local_path, sizeof(local_path)))
+            continue;
+
+        prefetch->entry_by_name.emplace(std::move(normalized_name), prefetch->entries.size());
+        prefetch->entries.push_back({local_path});
+    }
+
+    if (prefetch->entries.empty())
+        return;
+
+    unsigned int workers_count = std::clamp(std::thread::hardware_concurrency(), 1u, MAX_WORKERS);
+    workers_count = std::min(workers_count, (unsigned int)prefetch->entries.size());
+
+    for (unsigned int i = 0; i < workers_count; i++)
+    {
+        if (TaskRun::RunInBackground([prefetch] { PrefetchWorker(prefetch); }).has_error())
+            break;
+    }
+
+    g_ModelPrefetch = prefetch;
+}
+
+bool ModPrefetch_Take(const char* name, ModelPrefetchBuffer& buffer)
+{
+    OPTICK_EVENT();
+
+    if (g_ModelPrefetch == nullptr)
+        return false;
+
+    auto prefetch = g_ModelPrefetch;
+    std::unique_lock lock(prefetch->mutex);
+
+    auto it = prefetch->entry_by_name.find(NormalizeName(name));
+    if (it == prefetch->entry_by_name.end())
+        return false;
+
+    auto& entry = prefetch->entries[it->second];
+
+    // not started yet, loading it here is faster than waiting for the workers
+    if (entry.state == PrefetchEntryState::Pending)
+    {
+        entry.state = PrefetchEntryState::Taken;
+        return false;
+    }
+
+    prefetch->cv.wait(lock, [&entry] { return entry.state != PrefetchEntryState::Reading; });
+
+    if (entry.state != PrefetchEntryState::Ready)
+        return false;
+
+    buffer = std::move(entry.buffer);
+    entry.buffer = {};
+    entry.state = PrefetchEntryState::Taken;
+
+    prefetch->buffered_bytes -= buffer.data.size();
+    prefetch->cv.notify_all();
+
+    return true;
+}
+
+void ModPrefetch_End()
+{
+    OPTICK_EVENT();
+
+    AbortPrefetch();
+
+    if (!g_IsModelPrefetchActive)
+        return;
+
+    g_IsModelPrefetchActive = false;
+
+    if (fs_precache_timings == nullptr || fs_precache_timings->value == 0.0f || g_ModelLoadTimings.empty())
+    {
+        g_ModelLoadTimings.clear();
+        return;
+    }
+
+    double total_io_time = 0;
+    double total_wait_time = 0;
+    double total_parse_time = 0;
+    int prefetched_count = 0;
+
+    Con_Printf("Model load times (ms):\n");
+    Con_Printf("%10s %10s %10s  %s\n", "io", "wait", "parse", "name");
+
+    for (const auto& timing : g_ModelLoadTimings)
+    {
+        Con_Printf("%10.2f %10.2f %10.2f  %s%s\n", timing.io_time * 1000, timing.wait_time * 1000, timing.parse_time * 1000,
+                   timing.name.c_str(), timing.is_prefetched ? "" : " (not prefetched)");
+
+        total_io_time += timing.io_time;
+        total_wait_time += timing.wait_time;
+        total_parse_time += timing.parse_time;
+
+        if (timing.is_prefetched)
+            prefetched_count++;
+    }
+
+    Con_Printf("%10.2f %10.2f %10.2f  total, %d of %d models prefetched\n", total_io_time * 1000, total_wait_time * 1000,
+               total_parse_time * 1000, prefetched_count, (int)g_ModelLoadTimings.size());
+
+    g_ModelLoadTimings.clear();
+}
+
+void ModPrefetch_AddLoadTiming(const char* name, double io_time, double wait_time, double parse_time, bool is_prefetched)
+{
+    if (!g_IsModelPrefetchActive)
+        return;
+
+    g_ModelLoadTimings.push_back({name, io_time, wait_time, parse_time, is_prefetched});
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <crc.h>
+
+struct ModelPrefetchBuffer
+{
+    // the file data followed by a null terminator, like COM_LoadFile returns
+    std::vector<uint8_t> data;
+    CRC32_t crc32 = 0;
+    double io_time = 0;
+};
+
+// Starts reading the files of the models on the thread pool, in the order they will be loaded.
+// Only the files on disk are prefetched, the files in the pak archives are loaded as before.
+void ModPrefetch_Begin(const std::vector<std::string>& names);
+// Moves the prefetched file of the model to the buffer, waits if it's still being read.
+// Returns false if the file isn't prefetched and must be loaded on the calling thread.
+bool ModPrefetch_Take(const char* name, ModelPrefetchBuffer& buffer);
+// Drops the files which weren't taken and prints the load report if fs_precache_timings is set
+void ModPrefetch_End();
+
+// Adds the load timings of a model to the report
+void ModPrefetch_AddLoadTiming(const char* name, double io_time, double wait_time, double parse_time, bool is_prefetched);
@@ -9,6 +9,8 @@
 #include "../resource_descriptor.h"
 #include "../client/cl_private_resources.h"
 #include "../client/download.h"
+#include "../client/http_download/DownloadFileStream.h"
+#include <metaaudio.h>
 
 void Netchan_Setup(netsrc_t socketnumber, netchan_t* chan, netadr_t adr, int player_slot, void* connection_status,
                    qboolean (*pfnNetchan_Blocksize)(void*))
@@ -18,6 +20,147 @@ void Netchan_Setup(netsrc_t socketnumber, netchan_t* chan, netadr_t adr, int pla
     eng()->Netchan_Setup(socketnumber, chan, adr, player_slot, connection_status, pfnNetchan_Blocksize);
 }
 
+/**
+ * \brief Writes the file fragments straight to the files of all save paths of the download path,
+ * bz2 data is decompressed on the fly, so the file is never assembled in memory.
+ * Frees the fragments.
+ */
+static qboolean Netchan_StreamFileFragments(netchan_t* chan, const char* filename, bool compressed, unsigned int uncompressed_size)
+{
+    const size_t DECOMPRESS_CHUNK_SIZE = 64 * 1024;
+
+    auto descs = ResDesc_MakeByDownloadPath(filename);
+
+    std::vector<std::unique_ptr<DownloadFileStream>> file_streams;
+    for (const auto& desc : descs)
+    {
+        auto& file_stream = file_streams.emplace_back(std::make_unique<DownloadFileStream>(desc.save_path, 0));
+        file_stream->Open(false);
+    }
+
+    bz_stream bz{};
+    bool is_decompress_failed = compressed && BZ2_bzDecompressInit(&bz, 0, 1) != BZ_OK;
+    bool is_stream_end = false;
+    std::vector<char> decompress_chunk(compressed ? DECOMPRESS_CHUNK_SIZE : 0);
+    size_t total_size = 0;
+
+    auto write_all = [&](const char* data, size_t size)
+    {
+        total_size += size;
+        for (auto& file_stream : file_streams)
+            file_stream->Write(std::string_view(data, size));
+    };
+
+    fragbuf_t* p = chan->incomingbufs[FRAG_FILE_STREAM];
+    while (p)
+    {
+        fragbuf_t* n = p->next;
+
+        auto data = (char*)p->frag_message.data;
+        int size = p->frag_message.cursize;
+
+        // First message has the file name, don't write that into the data stream, just write the rest of the actual data
+        if (p == chan->incomingbufs[FRAG_FILE_STREAM])
+        {
+            data += *pMsg_readcount;
+            size -= *pMsg_readcount;
+        }
+
+        if (!compressed)
+        {
+            write_all(data, size);
+        }
+        else if (!is_decompress_failed && !is_stream_end)
+        {
+            bz.next_in = data;
+            bz.avail_in = size;
+
+            do
+            {
+                bz.next_out = decompress_chunk.data();
+                bz.avail_out = decompress_chunk.size();
+
+                int result = BZ2_bzDecompress(&bz);
+                if (result != BZ_OK && result != BZ_STREAM_END)
+                {
+                    is_decompress_failed = true;
+                    break;
+                }
+
+                // the sender declares the size, don't let it write more than that
+                size_t decompressed_size = decompress_chunk.size() - bz.avail_out;
+                if (total_size + decompressed_size > uncompressed_size)
+                {
+                    is_decompress_failed = true;
+                    break;
+                }
+
+                write_all(decompress_chunk.data(), decompressed_size);
+
+                is_stream_end = result == BZ_STREAM_END;
+            }
+            while (!is_stream_end && (bz.avail_in > 0 || bz.avail_out == 0));
+        }
+
+        Mem_Free(p);
+        p = n;
+    }
+
+    chan->incomingbufs[FRAG_FILE_STREAM] = nullptr;
+    chan->incomingready[FRAG_FILE_STREAM] = FALSE;
+
+    if (compressed)
+    {
+        BZ2_bzDecompressEnd(&bz);
+        Con_DPrintf(ConLogType::Info, "Decompressed file %s (%d -> %d)\n", filename, (int)bz.total_in_lo32, (int)total_size);
+
+        // a truncated stream decompresses without errors, but it's not the whole file
+        if (!is_stream_end || total_size != uncompressed_size)
+            is_decompress_failed = true;
+    }
+
+    if (is_decompress_failed)
+    {
+        for (auto& file_stream : file_streams)
+            file_stream->Discard();
+
+        g_DownloadFileLogger->AddLogFileError(filename, LogFileTypeError::FileSaveError, 0, 0);
+        Con_Printf("Can't decompress file %s\n", filename);
+        return FALSE;
+    }
+
+    if (total_size == 0)
+    {
+        for (auto& file_stream : file_streams)
+            file_stream->Discard();
+
+        g_DownloadFileLogger->AddLogFileError(filename, LogFileTypeError::FileMissing, 0, 0);
+        return TRUE;
+    }
+
+    for (size_t i = 0; i < descs.size(); i++)
+    {
+        const auto& desc = descs[i];
+
+        bool is_saved = file_streams[i]->Commit();
+        ResDesc_UpdateFileCRC32(desc, file_streams[i]->get_crc32());
+
+        if (!is_saved)
+        {
+            g_DownloadFileLogger->AddLogFileError(desc.save_path.c_str(), LogFileTypeError::FileSaveError, 0, 0);
+
+            Con_Printf("File open failed %s\n", desc.save_path.c_str());
+            Netchan_FlushIncoming(chan, FRAG_FILE_STREAM);
+            return FALSE;
+        }
+
+        g_DownloadFileLogger->AddLogFile(desc.download_path.c_str(), desc.download_size, LogFileType::FileDownloaded);
+        S_OnFileDownloaded(desc.filename.c_str());
+    }
+
+    return TRUE;
+}
+
 qboolean Netchan_CopyFileFragments(netchan_t* chan)
 {
     OPTICK_EVENT();
@@ -122,6 +265,18 @@ qboolean Netchan_CopyFileFragments(netchan_t* chan)
         }
     }
 
+    // regular files are written to disk as fragments are walked, only the private resource list
+    // and customizations are needed in memory
+    if (!is_private_res_list && filename[0] != '!')
+    {
+        qboolean result = Netchan_StreamFileFragments(chan, filename, bCompressed, uncompressedSize);
+
+        SZ_Clear(net_message);
+        *pMsg_readcount = 0;
+
+        return result;
+    }
+
     nsize = 0;
     while (p)
     {
@@ -201,34 +356,6 @@ qboolean Netchan_CopyFileFragments(netchan_t* chan)
         chan->tempbuffer = buffer;
         chan->tempbuffersize = pos;
     }
-    else
-    {
-        if (pos > 0)
-        {
-            for (const auto& desc : ResDesc_MakeByDownloadPath(filename))
-            {
-                bool is_saved = ResDesc_SaveToFile(desc, (const char*)buffer, pos);
-                if (!is_saved)
-                {
-                    g_DownloadFileLogger->AddLogFileError(desc.save_path.c_str(), LogFileTypeError::FileSaveError, 0, 0);
-
-                    Con_Printf("File open failed %s\n", desc.save_path.c_str());
-                    Netchan_FlushIncoming(chan, FRAG_FILE_STREAM);
-
-                    Mem_Free(buffer);
-                    return FALSE;
-                }
-
-                g_DownloadFileLogger->AddLogFile(desc.download_path.c_str(), desc.download_size, LogFileType::FileDownloaded);
-            }
-        }
-        else
-        {
-            g_DownloadFileLogger->AddLogFileError(filename, LogFileTypeError::FileMissing, 0, 0);
-        }
-
-        Mem_Free(buffer);
-    }
 
     SZ_Clear(net_message);
     *pMsg_readcount = 0;
@@ -1,7 +1,8 @@
 #include <filesystem>
-#include <fstream>
+#include <optional>
 #include <nitro_utils/string_utils.h>
 #include "resource_descriptor.h"
+#include "resource_index.h"
 #include "console/console.h"
 #include "common/zone.h"
 #include "common/filesystem.h"
@@ -19,6 +20,14 @@ static std::string GetDownloadsPrivateFolder()
     return std::format("{}_downloads_private/{}", gEngfuncs.pfnGetGameDirectory(), PrivateRes_GetPrivateFolder());
 }
 
+static ResourceIndex g_ResourceIndex;
+
+static ResourceIndex& GetResourceIndex()
+{
+    g_ResourceIndex.Load(std::format("{}_downloads_private/resource_index.txt", gEngfuncs.pfnGetGameDirectory()));
+    return g_ResourceIndex;
+}
+
 resource_descriptor_t ResDesc_Make(const std::string& file_path)
 {
     resource_descriptor_t desc;
@@ -79,23 +88,6 @@ std::vector<resource_descriptor_t> ResDesc_MakeByDownloadPath(const std::string&
     return descs;
 }
 
-bool ResDesc_SaveToFile(const resource_descriptor_t& descriptor, const char* data, int length)
-{
-    std::filesystem::path full_path = descriptor.save_path;
-
-    if (full_path.has_parent_path())
-        std::filesystem::create_directories(full_path.parent_path());
-
-    std::ofstream file(full_path, std::ios::out | std::ios::binary);
-    if (!file.is_open())
-        return false;
-
-    if (!file.write((const char*)data, length))
-        return false;
-
-    return true;
-}
-
 bool ResDesc_NeedToDownload(const resource_descriptor_t& descriptor)
 {
     if (std::filesystem::exists(descriptor.save_path) || FS_FileExists(descriptor.filename.c_str()))
@@ -111,30 +103,57 @@ bool ResDesc_NeedToDownload(const resource_descriptor_t& descriptor)
 
 CRC32_t ResDesc_CalcFileCRC32(const resource_descriptor_t& descriptor)
 {
-    std::ifstream file(descriptor.save_path, std::ifstream::in | std::ifstream::ate | std::ifstream::binary);
-    if (!file.is_open())
+    std::string error;
+    auto crc32 = GetResourceIndex().CalcFileCRC32(descriptor.save_path, error);
+    if (!crc32)
     {
-        Con_DPrintf(ConLogType::Info, "Can't open file \"%s\" to check crc\n", descriptor.save_path.c_str());
+        Con_DPrintf(ConLogType::Info, "%s\n", error.c_str());
         return true;
     }
-    std::streamsize file_size = file.tellg();
-    file.seekg(0, std::ios::beg);
 
-    std::vector<char> file_buffer(file_size);
+    return *crc32;
+}
+
+std::vector<CRC32_t> ResDesc_CalcFilesCRC32(const std::vector<resource_descriptor_t>& descriptors)
+{
+    std::vector<std::string> paths;
+    paths.reserve(descriptors.size());
+    for (const auto& descriptor : descriptors)
+        paths.push_back(descriptor.save_path);
+
+    std::vector<std::string> errors;
+    auto crc32s = GetResourceIndex().CalcFilesCRC32(paths, errors);
 
-    if (!file.read(file_buffer.data(), file_size))
+    for (const auto& error : errors)
     {
-        Con_Printf("Can't read file \"%s\" to check crc\n", descriptor.save_path.c_str());
-        return true;
+        if (!error.empty())
+            Con_DPrintf(ConLogType::Info, "%s\n", error.c_str());
     }
-    file.close();
 
-    CRC32_t crc32;
-    g_engfuncs.pfnCRC32_Init(&crc32);
-    g_engfuncs.pfnCRC32_ProcessBuffer(&crc32, file_buffer.data(), file_size);
-    crc32 = g_engfuncs.pfnCRC32_Final(crc32);
+    std::vector<CRC32_t> result(descriptors.size(), true);
+    for (size_t i = 0; i < crc32s.size(); i++)
+    {
+        if (crc32s[i])
+            result[i] = *crc32s[i];
+    }
+
+    return result;
+}
+
+void ResDesc_UpdateFileCRC32(const resource_descriptor_t& descriptor, std::optional<CRC32_t> crc32)
+{
+    uint64_t size;
+    int64_t mtime;
 
-    return crc32;
+    if (crc32 && ResourceIndex::GetFileStat(descriptor.save_path, size, mtime))
+        GetResourceIndex().Update(descriptor.save_path, size, mtime, *crc32);
+    else
+        GetResourceIndex().Remove(descriptor.save_path);
+}
+
+void ResDesc_SaveIndex()
+{
+    GetResourceIndex().Save();
 }
 
 std::unordered_map<std::string, resource_descriptor_t> ResDesc_GetAllOverwriteResources()
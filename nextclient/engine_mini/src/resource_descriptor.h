@@ -2,6 +2,8 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include <optional>
 #include <crc.h>
 #include "hlsdk.h"
 
@@ -20,10 +22,16 @@ resource_descriptor_t ResDesc_Make(const std::string& file_path);
 resource_descriptor_t ResDesc_Make(resource_t* resource);
 std::vector<resource_descriptor_t> ResDesc_MakeByDownloadPath(const std::string& download_file_path);
 
-// Saves data to the path specified in save_path
-bool ResDesc_SaveToFile(const resource_descriptor_t& descriptor, const char* data, int length);
 //uint8_t* ResDesc_LoadFromFile(const resource_descriptor_t& descriptor, int* length_out);
 bool ResDesc_NeedToDownload(const resource_descriptor_t& descriptor);
+// Returns the crc32 from the resource index if the file is unchanged since it was hashed, otherwise calculates it
 CRC32_t ResDesc_CalcFileCRC32(const resource_descriptor_t& descriptor);
+// Same as ResDesc_CalcFileCRC32 for a list of files, the files are hashed in parallel
+std::vector<CRC32_t> ResDesc_CalcFilesCRC32(const std::vector<resource_descriptor_t>& descriptors);
+// Indexes the crc32 of the file just written to save_path, drops the indexed one if the crc32 is unknown.
+// Must be called whenever the file is written, otherwise an outdated crc32 can be taken from the index
+void ResDesc_UpdateFileCRC32(const resource_descriptor_t& descriptor, std::optional<CRC32_t> crc32);
+// Writes the resource index to disk if it has changed
+void ResDesc_SaveIndex();
 
 std::unordered_map<std::string, resource_descriptor_t> ResDesc_GetAllOverwriteResources();
@@ -0,0 +1,193 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <format>
+#include <execution>
+#include <numeric>
+#include "resource_index.h"
+#include "utils/Crc32.h"
+#include "utils/MappedFile.h"
+
+// crc32, size, mtime and path separated by spaces on each line, the path is the last since it may contain spaces
+static constexpr char INDEX_HEADER[] = "resource_index 1";
+
+void ResourceIndex::Load(const std::string& index_path)
+{
+    std::lock_guard lock(mutex_);
+
+    if (index_path_ == index_path)
+        return;
+
+    SaveLocked();
+
+    index_path_ = index_path;
+    entries_.clear();
+    is_dirty_ = false;
+
+    std::ifstream file(index_path_);
+    if (!file.is_open())
+        return;
+
+    std::string line;
+    if (!std::getline(file, line) || line != INDEX_HEADER)
+        return;
+
+    while (std::getline(file, line))
+    {
+        std::istringstream line_stream(line);
+
+        Entry entry{};
+        unsigned long crc32 = 0;
+        line_stream >> std::hex >> crc32 >> std::dec >> entry.size >> entry.mtime;
+        if (!line_stream || line_stream.get() != ' ')
+            continue;
+
+        std::string path;
+        std::getline(line_stream, path);
+        if (path.empty())
+            continue;
+
+        entry.crc32 = (CRC32_t)crc32;
+        entries_[path] = entry;
+    }
+}
+
+void ResourceIndex::Save()
+{
+    std::lock_guard lock(mutex_);
+    SaveLocked();
+}
+
+void ResourceIndex::SaveLocked()
+{
+    if (!is_dirty_ || index_path_.empty())
+        return;
+
+    std::filesystem::path full_path = index_path_;
+    std::error_code ec;
+    if (full_path.has_parent_path())
+        std::filesystem::create_directories(full_path.parent_path(), ec);
+
+    std::ofstream file(full_path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return;
+
+    file << INDEX_HEADER << '\n';
+    for (const auto& [path, entry] : entries_)
+        file << std::hex << (unsigned long)entry.crc32 << std::dec << ' ' << entry.size << ' ' << entry.mtime << ' ' << path << '\n';
+
+    if (file)
+        is_dirty_ = false;
+}
+
+std::optional<CRC32_t> ResourceIndex::Find(const std::string& path, uint64_t size, int64_t mtime)
+{
+    std::lock_guard lock(mutex_);
+
+    auto it = entries_.find(path);
+    if (it == entries_.end() || it->second.size != size || it->second.mtime != mtime)
+        return std::nullopt;
+
+    return it->second.crc32;
+}
+
+void ResourceIndex::Update(const std::string& path, uint64_t size, int64_t mtime, CRC32_t crc32)
+{
+    std::lock_guard lock(mutex_);
+
+    entries_[path] = {size, mtime, crc32};
+    is_dirty_ = true;
+}
+
+void ResourceIndex::Remove(const std::string& path)
+{
+    std::lock_guard lock(mutex_);
+
+    if (entries_.erase(path) != 0)
+        is_dirty_ = true;
+}
+
+std::optional<CRC32_t> ResourceIndex::CalcFileCRC32(const std::string& path, std::string& error)
+{
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    bool has_stat = GetFileStat(path, size, mtime);
+
+    if (has_stat)
+    {
+        auto indexed_crc32 = Find(path, size, mtime);
+        if (indexed_crc32)
+            return indexed_crc32;
+    }
+
+    CRC32_t crc32;
+    MappedFile mapped_file(path);
+
+    if (mapped_file.is_open())
+    {
+        crc32 = Crc32_Calc(mapped_file.data(), mapped_file.size());
+    }
+    else
+    {
+        // the file may not fit into the address space, read it by chunks
+        std::ifstream file(path, std::ifstream::in | std::ifstream::binary);
+        if (!file.is_open())
+        {
+            error = std::format("Can't open file \"{}\" to check crc", path);
+            return std::nullopt;
+        }
+
+        std::vector<char> file_buffer(64 * 1024);
+        uint32_t crc_state = 0xFFFFFFFF;
+
+        while (file)
+        {
+            file.read(file_buffer.data(), (std::streamsize)file_buffer.size());
+            crc_state = Crc32_ProcessBuffer(crc_state, file_buffer.data(), (size_t)file.gcount());
+        }
+
+        if (!file.eof())
+        {
+            error = std::format("Can't read file \"{}\" to check crc", path);
+            return std::nullopt;
+        }
+
+        crc32 = crc_state ^ 0xFFFFFFFF;
+    }
+
+    if (has_stat)
+        Update(path, size, mtime, crc32);
+
+    return crc32;
+}
+
+std::vector<std::optional<CRC32_t>> ResourceIndex::CalcFilesCRC32(const std::vector<std::string>& paths, std::vector<std::string>& errors)
+{
+    std::vector<std::optional<CRC32_t>> result(paths.size());
+    errors.assign(paths.size(), std::string());
+
+    std::vector<size_t> indices(paths.size());
+    std::iota(indices.begin(), indices.end(), 0);
+
+    std::for_each(std::execution::par, indices.cbegin(), indices.cend(), [&](size_t i)
+    {
+        result[i] = CalcFileCRC32(paths[i], errors[i]);
+    });
+
+    return result;
+}
+
+bool ResourceIndex::GetFileStat(const std::string& path, uint64_t& size, int64_t& mtime)
+{
+    std::error_code ec;
+    std::filesystem::directory_entry entry(path, ec);
+    if (ec || !entry.is_regular_file(ec))
+        return false;
+
+    size = entry.file_size(ec);
+    if (ec)
+        return false;
+
+    mtime = entry.last_write_time(ec).time_since_epoch().count();
+    return !ec;
+}
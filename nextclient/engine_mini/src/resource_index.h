@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <crc.h>
+
+// Persistent index of the CRC32 of downloaded files, keyed by save path.
+// An entry is valid while the size and the modification time of the file are unchanged,
+// so the files are hashed only once instead of on every connection.
+// The methods are thread-safe, the file saves are reported from the download threads.
+class ResourceIndex
+{
+    struct Entry
+    {
+        uint64_t size;
+        int64_t mtime;
+        CRC32_t crc32;
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::string index_path_;
+    bool is_dirty_ = false;
+
+public:
+    // Loads the index from the path, does nothing if it's already loaded from the same path
+    void Load(const std::string& index_path);
+    // Writes the index to disk if it has changed since the last save
+    void Save();
+
+    std::optional<CRC32_t> Find(const std::string& path, uint64_t size, int64_t mtime);
+    void Update(const std::string& path, uint64_t size, int64_t mtime, CRC32_t crc32);
+    void Remove(const std::string& path);
+
+    // Returns the indexed crc32 if the file is unchanged since it was hashed, otherwise hashes the file and indexes it.
+    // Errors are returned instead of printing since it runs on the thread pool
+    std::optional<CRC32_t> CalcFileCRC32(const std::string& path, std::string& error);
+    // Same as CalcFileCRC32 for a list of files, the files are hashed in parallel
+    std::vector<std::optional<CRC32_t>> CalcFilesCRC32(const std::vector<std::string>& paths, std::vector<std::string>& errors);
+
+    static bool GetFileStat(const std::string& path, uint64_t& size, int64_t& mtime);
+
+private:
+    void SaveLocked();
+};
@@ -0,0 +1,61 @@
+#include "Crc32.h"
+#include <array>
+#include <cstring>
+
+using Crc32Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+static constexpr Crc32Tables MakeCrc32Tables()
+{
+    Crc32Tables tables{};
+
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+
+        tables[0][i] = crc;
+    }
+
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        for (size_t slice = 1; slice < tables.size(); slice++)
+            tables[slice][i] = (tables[slice - 1][i] >> 8) ^ tables[0][tables[slice - 1][i] & 0xFF];
+    }
+
+    return tables;
+}
+
+static constexpr Crc32Tables kCrc32Tables = MakeCrc32Tables();
+
+uint32_t Crc32_ProcessBuffer(uint32_t crc, const void* data, size_t length)
+{
+    auto bytes = (const uint8_t*)data;
+    const auto& t = kCrc32Tables;
+
+    while (length >= 8)
+    {
+        // little endian load, the engine runs only on x86
+        uint32_t low;
+        uint32_t high;
+        std::memcpy(&low, bytes, sizeof(low));
+        std::memcpy(&high, bytes + 4, sizeof(high));
+        low ^= crc;
+
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+              t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+
+        bytes += 8;
+        length -= 8;
+    }
+
+    while (length-- > 0)
+        crc = (crc >> 8) ^ t[0][(crc ^ *bytes++) & 0xFF];
+
+    return crc;
+}
+
+uint32_t Crc32_Calc(const void* data, size_t length)
+{
+    return Crc32_ProcessBuffer(0xFFFFFFFF, data, length) ^ 0xFFFFFFFF;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// CRC-32 (IEEE 802.3) compatible with the engine's CRC32_Init/CRC32_ProcessBuffer/CRC32_Final,
+// processes 8 bytes per step with the slicing-by-8 tables instead of one byte.
+// Thread-safe, unlike the engine functions it can be used from the thread pool.
+uint32_t Crc32_ProcessBuffer(uint32_t crc, const void* data, size_t length);
+uint32_t Crc32_Calc(const void* data, size_t length);
@@ -0,0 +1,65 @@
+#include "MappedFile.h"
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+
+    file_handle_ = file;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || (uint64_t)file_size.QuadPart > SIZE_MAX)
+    {
+        Close();
+        return;
+    }
+
+    size_ = (size_t)file_size.QuadPart;
+    if (size_ == 0)
+    {
+        is_open_ = true;
+        return;
+    }
+
+    mapping_handle_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle_ == nullptr)
+    {
+        Close();
+        return;
+    }
+
+    data_ = (const uint8_t*)MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0);
+    if (data_ == nullptr)
+    {
+        Close();
+        return;
+    }
+
+    is_open_ = true;
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+void MappedFile::Close()
+{
+    if (data_ != nullptr)
+        UnmapViewOfFile(data_);
+
+    if (mapping_handle_ != nullptr)
+        CloseHandle(mapping_handle_);
+
+    if (file_handle_ != nullptr)
+        CloseHandle(file_handle_);
+
+    data_ = nullptr;
+    mapping_handle_ = nullptr;
+    file_handle_ = nullptr;
+    size_ = 0;
+    is_open_ = false;
+}
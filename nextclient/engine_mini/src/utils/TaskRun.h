@@ -34,4 +34,11 @@ public:
         return task_impl_->RunInMainThread(std::forward<callable_type>(callable), std::forward<argument_types>(arguments)...);
     }
 
+    // Runs the callable on the thread pool, results should be passed back with RunInMainThread
+    template<class callable_type, class... argument_types>
+    static Result RunInBackground(callable_type&& callable, argument_types&&... arguments)
+    {
+        return task_impl_->RunInBackground(std::forward<callable_type>(callable), std::forward<argument_types>(arguments)...);
+    }
+
 };
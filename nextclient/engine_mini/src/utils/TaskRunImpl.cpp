@@ -5,6 +5,7 @@ TaskRunImpl::TaskRunImpl(nitroapi::NitroApiInterface* nitro_api) :
 {
     ccruntime_ = std::make_unique<concurrencpp::runtime>();
     update_executor_ = ccruntime_->make_manual_executor();
+    background_executor_ = ccruntime_->thread_pool_executor();
 
     DeferUnsub(eng()->Host_FilterTime += [this](float delta, int result) { if (result) OnUpdate(); });
     DeferUnsub(eng()->Host_Shutdown |= [this](const auto& next) {  OnShutdown(); next->Invoke(); });
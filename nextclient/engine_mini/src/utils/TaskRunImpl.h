@@ -9,6 +9,7 @@ class TaskRunImpl : public nitroapi::NitroApiHelper
 {
     std::unique_ptr<concurrencpp::runtime> ccruntime_;
     std::shared_ptr<concurrencpp::manual_executor> update_executor_;
+    std::shared_ptr<concurrencpp::thread_pool_executor> background_executor_;
 
     std::vector<std::shared_ptr<nitroapi::Unsubscriber>> unsubs_;
 
@@ -58,6 +59,26 @@ public:
         }
     }
 
+    template<class callable_type, class... argument_types>
+    Result RunInBackground(callable_type&& callable, argument_types&&... arguments)
+    {
+        if (background_executor_ == nullptr)
+            return Result(ResultError("Not initialized"));
+
+        if (background_executor_->shutdown_requested())
+            return Result(ResultError("Shutdown requested"));
+
+        try
+        {
+            background_executor_->post(std::forward<callable_type>(callable), std::forward<argument_types>(arguments)...);
+            return Result();
+        }
+        catch (concurrencpp::errors::runtime_shutdown& e)
+        {
+            return ResultError(e.what());
+        }
+    }
+
 private:
     void OnUpdate();
     void OnShutdown();
@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Utilities/ChannelPool.hpp"
+
+using namespace MetaAudio;
+
+// the channels of the tests have no sentences, the destructor of snd_local.cpp closes the mouth through the engine
+aud_channel_t::~aud_channel_t() = default;
+
+static std::vector<size_t> GetActiveSlots(ChannelPool& pool)
+{
+    std::vector<size_t> slots;
+    pool.ForEach([&](aud_channel_t& channel) { slots.push_back(pool.GetSlot(&channel)); });
+
+    return slots;
+}
+
+static std::vector<size_t> GetEntitySlots(const ChannelPool& pool, int entnum)
+{
+    auto slots = pool.GetEntitySlots(entnum);
+    if (slots == nullptr)
+        return {};
+
+    return std::vector<size_t>(slots->begin(), slots->end());
+}
+
+TEST(ChannelPoolTest, AllocatesUpToCapacity)
+{
+    ChannelPool pool(4);
+
+    for (size_t slot = 0; slot < 4; slot++)
+    {
+        auto channel = pool.Allocate(1, CHAN_AUTO);
+        ASSERT_NE(channel, nullptr);
+
+        // the lowest slots are allocated first
+        EXPECT_EQ(pool.GetSlot(channel), slot);
+        EXPECT_TRUE(pool.Contains(channel));
+    }
+
+    EXPECT_EQ(pool.Allocate(1, CHAN_AUTO), nullptr);
+
+    pool.Free(2);
+    auto channel = pool.Allocate(2, CHAN_VOICE);
+    ASSERT_NE(channel, nullptr);
+    EXPECT_EQ(pool.GetSlot(channel), 2);
+    EXPECT_EQ(channel->entnum, 2);
+    EXPECT_EQ(channel->entchannel, CHAN_VOICE);
+}
+
+TEST(ChannelPoolTest, FreeMovesLastActiveChannel)
+{
+    ChannelPool pool(8);
+
+    std::vector<aud_channel_t*> channels;
+    for (int entnum = 0; entnum < 4; entnum++)
+        channels.push_back(pool.Allocate(entnum, CHAN_AUTO));
+
+    pool.Free(1);
+    EXPECT_EQ(GetActiveSlots(pool), (std::vector<size_t>{ 0, 3, 2 }));
+
+    pool.Free(0);
+    EXPECT_EQ(GetActiveSlots(pool), (std::vector<size_t>{ 2, 3 }));
+
+    // the other channels stay in their slots
+    EXPECT_EQ(&pool[2], channels[2]);
+    EXPECT_EQ(channels[2]->entnum, 2);
+    EXPECT_EQ(&pool[3], channels[3]);
+    EXPECT_EQ(channels[3]->entnum, 3);
+
+    // the last freed slot is allocated first
+    auto channel = pool.Allocate(5, CHAN_AUTO);
+    EXPECT_EQ(pool.GetSlot(channel), 0);
+    EXPECT_EQ(GetActiveSlots(pool), (std::vector<size_t>{ 2, 3, 0 }));
+
+    // freed channels are reset
+    EXPECT_EQ(pool[1].entnum, 0);
+    EXPECT_EQ(pool[1].sfx, nullptr);
+}
+
+TEST(ChannelPoolTest, EntitySlotsKeepAllocationOrder)
+{
+    ChannelPool pool(8);
+
+    pool.Allocate(1, CHAN_WEAPON);
+    pool.Allocate(2, CHAN_WEAPON);
+    pool.Allocate(1, CHAN_VOICE);
+    pool.Allocate(1, CHAN_ITEM);
+
+    EXPECT_EQ(GetEntitySlots(pool, 1), (std::vector<size_t>{ 0, 2, 3 }));
+    EXPECT_EQ(GetEntitySlots(pool, 2), (std::vector<size_t>{ 1 }));
+
+    // freeing moves the active slots, but not the slots of the entity
+    pool.Free(0);
+    EXPECT_EQ(GetEntitySlots(pool, 1), (std::vector<size_t>{ 2, 3 }));
+
+    pool.Allocate(1, CHAN_BODY);
+    EXPECT_EQ(GetEntitySlots(pool, 1), (std::vector<size_t>{ 2, 3, 0 }));
+
+    pool.FreeIf([](aud_channel_t& channel) { return channel.entnum == 1; });
+    EXPECT_EQ(pool.GetEntitySlots(1), nullptr);
+    EXPECT_EQ(GetEntitySlots(pool, 2), (std::vector<size_t>{ 1 }));
+
+    pool.Clear();
+    EXPECT_TRUE(GetActiveSlots(pool).empty());
+    EXPECT_EQ(pool.GetEntitySlots(2), nullptr);
+}
+
+TEST(ChannelPoolTest, StaticChannelWithoutSoundIsReusedFirst)
+{
+    ChannelPool pool(8);
+    sfx_t sounds[3]{};
+
+    for (int i = 0; i < 3; i++)
+        pool.Allocate(i + 1, CHAN_STATIC)->sfx = &sounds[i];
+
+    // the sound of the second channel failed to load
+    pool[1].sfx = nullptr;
+
+    auto channel = pool.AllocateStatic(1, CHAN_STATIC, &sounds[0]);
+    ASSERT_NE(channel, nullptr);
+
+    // the channel without a sound is taken instead of the channel of the entity playing the same sound
+    EXPECT_EQ(pool.GetSlot(channel), 1);
+    EXPECT_EQ(channel->entnum, 1);
+    EXPECT_EQ(pool[0].sfx, &sounds[0]);
+    EXPECT_EQ(GetActiveSlots(pool).size(), 3);
+}
+
+TEST(ChannelPoolTest, StaticChannelReplacesSameSoundOfEntity)
+{
+    ChannelPool pool(8);
+    sfx_t sounds[2]{};
+
+    pool.Allocate(1, CHAN_STATIC)->sfx = &sounds[0];
+    pool.Allocate(1, CHAN_STATIC)->sfx = &sounds[1];
+    pool.Allocate(2, CHAN_STATIC)->sfx = &sounds[0];
+
+    auto channel = pool.AllocateStatic(1, CHAN_STATIC, &sounds[0]);
+    ASSERT_NE(channel, nullptr);
+    channel->sfx = &sounds[0];
+
+    EXPECT_EQ(pool.GetSlot(channel), 0);
+    EXPECT_EQ(GetActiveSlots(pool).size(), 3);
+    EXPECT_EQ(GetEntitySlots(pool, 1), (std::vector<size_t>{ 1, 0 }));
+
+    // another sound of the entity gets a new channel
+    sfx_t other_sound{};
+    channel = pool.AllocateStatic(1, CHAN_STATIC, &other_sound);
+    EXPECT_EQ(pool.GetSlot(channel), 3);
+    EXPECT_EQ(GetActiveSlots(pool).size(), 4);
+}
+
+// The static channels as they were stored before the pool: a vector the channels were erased from
+class ChannelVector
+{
+    std::vector<aud_channel_t> m_channels;
+
+public:
+    aud_channel_t* AllocateStatic(int entnum, int entchannel, sfx_t* sfx)
+    {
+        auto channel = std::find_if(m_channels.begin(), m_channels.end(), [&](aud_channel_t& channel)
+        {
+            return channel.sfx == nullptr ||
+                (channel.sfx == sfx && channel.entnum == entnum && (channel.entchannel == entchannel || entchannel == -1));
+        });
+        if (channel != m_channels.end())
+            m_channels.erase(channel);
+
+        auto& result = m_channels.emplace_back();
+        result.entnum = entnum;
+        result.entchannel = entchannel;
+        return &result;
+    }
+
+    template<class Predicate>
+    void FreeIf(const Predicate& predicate)
+    {
+        m_channels.erase(std::remove_if(m_channels.begin(), m_channels.end(), predicate), m_channels.end());
+    }
+
+    template<class Functor>
+    void ForEach(const Functor& lambda)
+    {
+        for (auto& channel : m_channels) lambda(channel);
+    }
+};
+
+struct ReplayEvent
+{
+    bool is_stop;
+    int entnum;
+    int entchannel;
+    size_t sound;
+    uint64_t duration;
+};
+
+// Ambient sounds of a map: the entities start and stop static sounds, which end after some frames.
+// Up to about 180 sounds play at once, so the pool of the channel manager is never full
+static std::vector<std::vector<ReplayEvent>> MakeReplayFrames(size_t frames_count)
+{
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> events_distribution(0, 4);
+    std::uniform_int_distribution<int> stop_distribution(0, 9);
+    std::uniform_int_distribution<int> entnum_distribution(1, 48);
+    std::uniform_int_distribution<int> entchannel_distribution(0, 3);
+    std::uniform_int_distribution<size_t> sound_distribution(0, 31);
+    std::uniform_int_distribution<uint64_t> duration_distribution(10, 150);
+
+    std::vector<std::vector<ReplayEvent>> frames(frames_count);
+    for (auto& frame : frames)
+    {
+        for (int i = events_distribution(random); i > 0; i--)
+        {
+            frame.push_back({ stop_distribution(random) == 0, entnum_distribution(random), entchannel_distribution(random),
+                sound_distribution(random), duration_distribution(random) });
+        }
+    }
+
+    return frames;
+}
+
+template<class Channels>
+static std::vector<std::tuple<int, int, sfx_t*>> Replay(Channels& channels, const std::vector<std::vector<ReplayEvent>>& frames, sfx_t* sounds)
+{
+    std::vector<std::tuple<int, int, sfx_t*>> result;
+
+    for (uint64_t frame = 0; frame < frames.size(); frame++)
+    {
+        for (const auto& event : frames[frame])
+        {
+            if (event.is_stop)
+            {
+                channels.FreeIf([&](aud_channel_t& channel) { return channel.entnum == event.entnum && channel.entchannel == event.entchannel; });
+                continue;
+            }
+
+            auto channel = channels.AllocateStatic(event.entnum, event.entchannel, &sounds[event.sound]);
+            if (channel)
+            {
+                channel->sfx = &sounds[event.sound];
+                channel->end = frame + event.duration;
+            }
+        }
+
+        // the finished channels are freed at the end of the frame
+        channels.FreeIf([&](aud_channel_t& channel) { return channel.end <= frame; });
+    }
+
+    channels.ForEach([&](aud_channel_t& channel) { result.emplace_back(channel.entnum, channel.entchannel, channel.sfx); });
+    std::sort(result.begin(), result.end());
+
+    return result;
+}
+
+TEST(ChannelPoolTest, StaticChannelReplay)
+{
+    constexpr size_t kFramesCount = 100000;
+
+    auto frames = MakeReplayFrames(kFramesCount);
+    sfx_t sounds[32]{};
+
+    auto measure = [](auto&& func)
+    {
+        auto start_time = std::chrono::steady_clock::now();
+        func();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    };
+
+    ChannelVector vector_channels;
+    std::vector<std::tuple<int, int, sfx_t*>> vector_result;
+    double vector_time = measure([&]() { vector_result = Replay(vector_channels, frames, sounds); });
+
+    ChannelPool pool_channels(256);
+    std::vector<std::tuple<int, int, sfx_t*>> pool_result;
+    double pool_time = measure([&]() { pool_result = Replay(pool_channels, frames, sounds); });
+
+    // both keep the same channels playing
+    EXPECT_EQ(pool_result, vector_result);
+
+    std::cout << std::format("[ BENCHMARK ] {} frames: {:.1f} ms with the vector, {:.1f} ms with the pool\n", kFramesCount, vector_time, pool_time);
+    RecordProperty("vector_ms", (int)vector_time);
+    RecordProperty("pool_ms", (int)pool_time);
+}
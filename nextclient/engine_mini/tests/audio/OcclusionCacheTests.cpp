@@ -0,0 +1,158 @@
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Effects/OcclusionCache.hpp"
+
+using namespace MetaAudio;
+
+// Returns the attenuation as the gain, so the tests can tell which request was calculated
+class OcclusionCalculatorMock : public IOcclusionCalculator
+{
+public:
+    int calculations = 0;
+    // the x of the calculated sources in the order of the calculations
+    std::vector<float> calculated_sources;
+
+    OcclusionFrequencyGain GetParameters(Vector3 listenerPosition,
+        Vector3 listenerAhead,
+        Vector3 listenerUp,
+        Vector3 audioSourcePosition,
+        float sourceRadius,
+        float attenuationMultiplier) override
+    {
+        calculations++;
+        calculated_sources.push_back(audioSourcePosition.X);
+        return OcclusionFrequencyGain{ attenuationMultiplier, attenuationMultiplier, attenuationMultiplier };
+    }
+};
+
+static OcclusionFrequencyGain GetParameters(OcclusionCache& cache, int entnum, float attenuation, float source_x = 4)
+{
+    return cache.GetParameters(entnum, Vector3{ 0, 0, 0 }, Vector3{ 0, 0, -1 }, Vector3{ 0, 1, 0 }, Vector3{ source_x, 0, 0 }, 0.5f, attenuation);
+}
+
+TEST(OcclusionCacheTest, SameSourceIsCalculatedOnce)
+{
+    auto calculator = std::make_shared<OcclusionCalculatorMock>();
+    OcclusionCache cache(calculator);
+
+    cache.BeginFrame(1.0, 0.5, 0);
+    GetParameters(cache, 1, 0.8f);
+
+    cache.BeginFrame(1.1, 0.5, 0);
+    auto gain = GetParameters(cache, 1, 0.8f);
+
+    EXPECT_EQ(calculator->calculations, 1);
+    EXPECT_FLOAT_EQ(gain.Low, 0.8f);
+}
+
+TEST(OcclusionCacheTest, EntityWithTwoAttenuationsIsCachedSeparately)
+{
+    auto calculator = std::make_shared<OcclusionCalculatorMock>();
+    OcclusionCache cache(calculator);
+
+    cache.BeginFrame(1.0, 0.5, 0);
+    auto normal_gain = GetParameters(cache, 1, 0.8f);
+    auto static_gain = GetParameters(cache, 1, 1.25f);
+
+    EXPECT_EQ(calculator->calculations, 2);
+    EXPECT_FLOAT_EQ(normal_gain.Mid, 0.8f);
+    EXPECT_FLOAT_EQ(static_gain.Mid, 1.25f);
+
+    // both entries are reused on the next frame
+    cache.BeginFrame(1.1, 0.5, 0);
+    EXPECT_FLOAT_EQ(GetParameters(cache, 1, 0.8f).Mid, 0.8f);
+    EXPECT_FLOAT_EQ(GetParameters(cache, 1, 1.25f).Mid, 1.25f);
+    EXPECT_EQ(calculator->calculations, 2);
+}
+
+TEST(OcclusionCacheTest, BudgetLimitsRefreshesPerFrame)
+{
+    auto calculator = std::make_shared<OcclusionCalculatorMock>();
+    OcclusionCache cache(calculator);
+
+    // the first values of the sources are calculated regardless of the budget
+    cache.BeginFrame(1.0, 0.5, 2);
+    for (int entnum = 1; entnum <= 6; entnum++)
+        GetParameters(cache, entnum, 0.8f, entnum * 100.0f);
+
+    EXPECT_EQ(calculator->calculations, 6);
+
+    // the entries are outdated on every frame, each frame refreshes the budget only
+    double time = 1.0;
+    for (int frame = 0; frame < 3; frame++)
+    {
+        time += 1.0;
+        cache.BeginFrame(time, 0.5, 2);
+        for (int entnum = 1; entnum <= 6; entnum++)
+            GetParameters(cache, entnum, 0.8f, entnum * 100.0f);
+
+        EXPECT_EQ(calculator->calculations, 6 + (frame + 1) * 2);
+    }
+}
+
+TEST(OcclusionCacheTest, BudgetRotatesRoundRobin)
+{
+    auto calculator = std::make_shared<OcclusionCalculatorMock>();
+    OcclusionCache cache(calculator);
+
+    cache.BeginFrame(1.0, 0.5, 2);
+    for (int entnum = 1; entnum <= 4; entnum++)
+        GetParameters(cache, entnum, 0.8f, entnum * 100.0f);
+
+    // each frame starts where the budget of the previous one ended, so every source is refreshed in turn
+    std::vector<std::vector<float>> expected_sources = {
+        { 300.0f, 400.0f },
+        { 100.0f, 200.0f },
+        { 300.0f, 400.0f },
+    };
+
+    double time = 1.0;
+    for (const auto& expected : expected_sources)
+    {
+        calculator->calculated_sources.clear();
+
+        time += 1.0;
+        cache.BeginFrame(time, 0.5, 2);
+        for (int entnum = 1; entnum <= 4; entnum++)
+            GetParameters(cache, entnum, 0.8f, entnum * 100.0f);
+
+        EXPECT_EQ(calculator->calculated_sources, expected);
+    }
+}
+
+TEST(OcclusionCacheTest, MovingSourceOutOfBudgetKeepsEntityValue)
+{
+    auto calculator = std::make_shared<OcclusionCalculatorMock>();
+    OcclusionCache cache(calculator);
+
+    cache.BeginFrame(1.0, 0.5, 1);
+    GetParameters(cache, 1, 0.8f, 100.0f);
+    GetParameters(cache, 2, 0.8f, 200.0f);
+    EXPECT_EQ(calculator->calculations, 2);
+
+    // the first entity moves to another cell when the budget belongs to the second one
+    cache.BeginFrame(1.1, 0.5, 1);
+    auto gain = GetParameters(cache, 1, 0.8f, 500.0f);
+    GetParameters(cache, 2, 0.8f, 200.0f);
+
+    EXPECT_EQ(calculator->calculations, 2);
+    EXPECT_FLOAT_EQ(gain.Mid, 0.8f);
+
+    // its turn comes on the next frame
+    calculator->calculated_sources.clear();
+    cache.BeginFrame(1.2, 0.5, 1);
+    GetParameters(cache, 1, 0.8f, 600.0f);
+    GetParameters(cache, 2, 0.8f, 200.0f);
+
+    EXPECT_EQ(calculator->calculated_sources, std::vector<float>{ 600.0f });
+
+    // the value of another attenuation is not taken, it's calculated as a new source
+    calculator->calculated_sources.clear();
+    cache.BeginFrame(1.3, 0.5, 1);
+    GetParameters(cache, 1, 1.25f, 700.0f);
+
+    EXPECT_EQ(calculator->calculated_sources, std::vector<float>{ 700.0f });
+}
@@ -0,0 +1,69 @@
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Utilities/SoundEnvelope.hpp"
+
+using namespace MetaAudio;
+
+static SoundEnvelope BuildEnvelope(std::vector<int16_t>& samples, bool with_quiet_samples)
+{
+    SoundEnvelope envelope;
+    envelope.Build(alure::ArrayView<ALbyte>(reinterpret_cast<ALbyte*>(samples.data()), samples.size() * sizeof(int16_t)),
+        alure::SampleType::Int16, alure::ChannelConfig::Mono, with_quiet_samples);
+
+    return envelope;
+}
+
+// loud samples with a quiet one every 100 samples
+static std::vector<int16_t> MakeSamples(size_t count)
+{
+    std::vector<int16_t> samples(count, 8000);
+    for (size_t i = 0; i < count; i += 100)
+        samples[i] = 100;
+
+    return samples;
+}
+
+TEST(SoundEnvelopeTest, QuietSamplesAreBuiltForSentenceWords)
+{
+    auto samples = MakeSamples(1000);
+    auto envelope = BuildEnvelope(samples, true);
+
+    EXPECT_TRUE(envelope.IsQuiet(0));
+    EXPECT_TRUE(envelope.IsQuiet(500));
+    EXPECT_FALSE(envelope.IsQuiet(501));
+    EXPECT_FALSE(envelope.IsQuiet(samples.size()));
+}
+
+TEST(SoundEnvelopeTest, QuietSamplesAreNotBuiltForOtherSounds)
+{
+    auto samples = MakeSamples(22050);
+    auto word_envelope = BuildEnvelope(samples, true);
+    auto envelope = BuildEnvelope(samples, false);
+
+    EXPECT_FALSE(envelope.IsQuiet(0));
+    EXPECT_FALSE(envelope.IsQuiet(500));
+
+    // the mouth movement gets the same amplitudes
+    ASSERT_EQ(envelope.GetWindowsCount(), word_envelope.GetWindowsCount());
+    for (size_t window = 0; window < envelope.GetWindowsCount(); window++)
+        EXPECT_EQ(envelope.GetAmplitude(window), word_envelope.GetAmplitude(window));
+
+    // one amplitude byte per window without the quiet bit per sample
+    EXPECT_EQ(envelope.GetMemoryUsage(), (samples.size() + SoundEnvelope::WINDOW_SIZE - 1) / SoundEnvelope::WINDOW_SIZE);
+    EXPECT_EQ(word_envelope.GetMemoryUsage(), envelope.GetMemoryUsage() + (samples.size() + 7) / 8);
+}
+
+TEST(SoundEnvelopeTest, StereoSoundsHaveNoEnvelope)
+{
+    std::vector<int16_t> samples(1000, 8000);
+
+    SoundEnvelope envelope;
+    envelope.Build(alure::ArrayView<ALbyte>(reinterpret_cast<ALbyte*>(samples.data()), samples.size() * sizeof(int16_t)),
+        alure::SampleType::Int16, alure::ChannelConfig::Stereo, true);
+
+    EXPECT_TRUE(envelope.empty());
+    EXPECT_FALSE(envelope.IsQuiet(0));
+}
@@ -0,0 +1,111 @@
+#include <random>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Vox/VoxTokenizer.hpp"
+
+using namespace MetaAudio;
+
+static constexpr std::string_view kComma = "_comma";
+static constexpr std::string_view kPeriod = "_period";
+
+// The regex based tokenizer which TokenizeVox replaced, kept as the reference
+static std::vector<std::string> TokenizeVoxRegex(std::string_view input)
+{
+    static const std::regex regex_match_vox(R"([,.]|[^\s,.]*\(.+?\)|\b[^\s,.]*[^\s.,])");
+
+    const auto psz = std::string(input);
+
+    std::vector<std::string> words;
+
+    auto matches_begin = std::sregex_iterator(psz.cbegin(), psz.cend(), regex_match_vox);
+    auto matches_end = std::sregex_iterator();
+    for (; matches_begin != matches_end; ++matches_begin)
+    {
+        const std::string& sub_match = (*matches_begin)[0];
+        if (sub_match == ",")
+            words.emplace_back(kComma);
+        else if (sub_match == ".")
+            words.emplace_back(kPeriod);
+        else
+            words.push_back(sub_match);
+    }
+
+    return words;
+}
+
+static std::vector<std::string> Tokenize(std::string_view input)
+{
+    auto words = TokenizeVox(input, kComma, kPeriod);
+
+    return std::vector<std::string>(words.begin(), words.end());
+}
+
+TEST(VoxTokenizerTest, SplitsPausesAndWords)
+{
+    EXPECT_EQ(Tokenize("hello, world."), (std::vector<std::string>{ "hello", "_comma", "world", "_period" }));
+    EXPECT_EQ(Tokenize("  hello   world  "), (std::vector<std::string>{ "hello", "world" }));
+    EXPECT_TRUE(Tokenize("").empty());
+    EXPECT_TRUE(Tokenize(" \t\n").empty());
+}
+
+TEST(VoxTokenizerTest, KeepsParameterBlocks)
+{
+    EXPECT_EQ(Tokenize("(p110 t40) clik!(p120) clik"), (std::vector<std::string>{ "(p110 t40)", "clik!(p120)", "clik" }));
+    EXPECT_EQ(Tokenize("doop(e50) doop"), (std::vector<std::string>{ "doop(e50)", "doop" }));
+
+    // an empty block isn't a parameter block
+    EXPECT_EQ(Tokenize("doop() doop"), TokenizeVoxRegex("doop() doop"));
+}
+
+TEST(VoxTokenizerTest, WordsPointIntoInput)
+{
+    std::string_view input = "hello, world";
+    auto words = TokenizeVox(input, kComma, kPeriod);
+
+    ASSERT_EQ(words.size(), 3);
+    EXPECT_EQ(words[0].data(), input.data());
+    EXPECT_EQ(words[1].data(), kComma.data());
+    EXPECT_EQ(words[2].data(), input.data() + 7);
+}
+
+TEST(VoxTokenizerTest, MatchesRegexOnSentences)
+{
+    const char* sentences[] =
+    {
+        "hgrunt/clik(p120) _comma check(e80) clik(p110)",
+        "barney/ba_later(t20) ba_cantfire",
+        "(e75) buzwarn(p110) buzwarn doop dadeda",
+        "vox/(p120) attention. all personnel, evacuate area!",
+        "fvox/bell(s0 e30) _period boop(e75 p60)",
+        "scientist/(t30 e90) sci_alone",
+    };
+
+    for (const char* sentence : sentences)
+    {
+        EXPECT_EQ(Tokenize(sentence), TokenizeVoxRegex(sentence)) << sentence;
+    }
+}
+
+TEST(VoxTokenizerTest, MatchesRegexOnRandomInputs)
+{
+    // the characters the tokenizer branches on, and some word characters
+    static constexpr std::string_view kAlphabet = "ab_1!-()(),, .. \t\n\r";
+
+    std::mt19937 random(1);
+    std::uniform_int_distribution<size_t> length_distribution(0, 24);
+    std::uniform_int_distribution<size_t> char_distribution(0, kAlphabet.size() - 1);
+
+    for (int i = 0; i < 200000; i++)
+    {
+        std::string input(length_distribution(random), '\0');
+        for (auto& c : input)
+            c = kAlphabet[char_distribution(random)];
+
+        ASSERT_EQ(Tokenize(input), TokenizeVoxRegex(input)) << "input \"" << input << "\"";
+    }
+}
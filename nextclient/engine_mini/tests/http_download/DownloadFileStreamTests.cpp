@@ -0,0 +1,120 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "DownloadFileStream.h"
+#include "utils/Crc32.h"
+
+namespace fs = std::filesystem;
+
+class DownloadFileStreamTest : public ::testing::Test
+{
+protected:
+    fs::path test_dir_;
+    std::string save_path_;
+
+    void SetUp() override
+    {
+        test_dir_ = fs::temp_directory_path() / "download_file_stream_test";
+        fs::remove_all(test_dir_);
+        fs::create_directories(test_dir_);
+
+        save_path_ = (test_dir_ / "file.dat").string();
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(test_dir_);
+    }
+
+    // Writes the first part of the file and leaves it with the journal, as an interrupted transfer does
+    void WritePartialFile(const std::string& data)
+    {
+        DownloadFileStream stream(save_path_, 4);
+        ASSERT_TRUE(stream.Open());
+        stream.OnHeader("HTTP/1.1 200 OK");
+        stream.OnHeader("ETag: \"v1\"");
+        ASSERT_TRUE(stream.Write(data));
+        stream.Suspend();
+    }
+
+    std::string ReadSavedFile() const
+    {
+        std::ifstream file(save_path_, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+};
+
+TEST_F(DownloadFileStreamTest, CommittedFileHasCrc32OfContent)
+{
+    const std::string content = "the content of the downloaded file";
+
+    DownloadFileStream stream(save_path_, 4);
+    ASSERT_TRUE(stream.Open());
+    stream.OnHeader("HTTP/1.1 200 OK");
+    ASSERT_TRUE(stream.Write(content.substr(0, 10)));
+    ASSERT_TRUE(stream.Write(content.substr(10)));
+
+    EXPECT_FALSE(stream.get_crc32());
+    ASSERT_TRUE(stream.Commit());
+
+    EXPECT_EQ(ReadSavedFile(), content);
+    ASSERT_TRUE(stream.get_crc32());
+    EXPECT_EQ(*stream.get_crc32(), Crc32_Calc(content.data(), content.size()));
+}
+
+TEST_F(DownloadFileStreamTest, ResumedFileHasCrc32OfWholeFile)
+{
+    const std::string first_part = "the first part, ";
+    const std::string second_part = "the second part";
+    const std::string content = first_part + second_part;
+
+    WritePartialFile(first_part);
+
+    DownloadFileStream stream(save_path_, 4);
+    ASSERT_TRUE(stream.Open());
+    ASSERT_EQ(stream.get_resume_offset(), first_part.size());
+
+    stream.OnHeader("HTTP/1.1 206 Partial Content");
+    stream.OnHeader("Content-Range: bytes " + std::to_string(first_part.size()) + "-" + std::to_string(content.size() - 1) + "/" + std::to_string(content.size()));
+    ASSERT_TRUE(stream.Write(second_part));
+    ASSERT_TRUE(stream.Commit());
+
+    EXPECT_EQ(ReadSavedFile(), content);
+    ASSERT_TRUE(stream.get_crc32());
+    EXPECT_EQ(*stream.get_crc32(), Crc32_Calc(content.data(), content.size()));
+}
+
+TEST_F(DownloadFileStreamTest, RestartedFileHasCrc32OfNewContent)
+{
+    const std::string content = "the whole file sent again by the server";
+
+    WritePartialFile("the outdated part");
+
+    DownloadFileStream stream(save_path_, 4);
+    ASSERT_TRUE(stream.Open());
+    ASSERT_GT(stream.get_resume_offset(), 0);
+
+    // the server ignores the Range request
+    stream.OnHeader("HTTP/1.1 200 OK");
+    ASSERT_TRUE(stream.Write(content));
+    ASSERT_TRUE(stream.Commit());
+
+    EXPECT_EQ(ReadSavedFile(), content);
+    ASSERT_TRUE(stream.get_crc32());
+    EXPECT_EQ(*stream.get_crc32(), Crc32_Calc(content.data(), content.size()));
+}
+
+TEST_F(DownloadFileStreamTest, DiscardedFileHasNoCrc32)
+{
+    DownloadFileStream stream(save_path_, 4);
+    ASSERT_TRUE(stream.Open());
+    stream.OnHeader("HTTP/1.1 200 OK");
+    ASSERT_TRUE(stream.Write("data"));
+    stream.Discard();
+
+    EXPECT_FALSE(stream.get_crc32());
+    EXPECT_FALSE(fs::exists(save_path_));
+}
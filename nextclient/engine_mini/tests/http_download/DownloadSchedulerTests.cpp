@@ -0,0 +1,276 @@
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "DownloadScheduler.h"
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+static QueuedRequest MakeRequest(const std::string& filename, int download_size, int retry = 0)
+{
+    resource_descriptor_t descriptor;
+    descriptor.filename = filename;
+    descriptor.save_path = filename;
+    descriptor.download_path = filename;
+    descriptor.download_size = download_size;
+
+    return QueuedRequest(descriptor, retry);
+}
+
+static std::vector<std::string> PopAll(DownloadScheduler& scheduler, DownloadScheduler::time_point now)
+{
+    std::vector<std::string> filenames;
+    while (const QueuedRequest* request = scheduler.Peek(now))
+    {
+        filenames.push_back(request->get_file_resource().filename);
+        scheduler.Pop(now);
+    }
+
+    return filenames;
+}
+
+static std::vector<std::string> PopAll(DownloadSchedulePolicy policy, const std::vector<QueuedRequest>& requests)
+{
+    DownloadScheduler scheduler;
+    scheduler.SetPolicy(policy);
+    for (const auto& request : requests)
+        scheduler.Push(request);
+
+    return PopAll(scheduler, system_clock::now());
+}
+
+// Replays a resource manifest against a transport with a fixed number of connections,
+// a request latency and a per connection throughput, the same way HttpDownloadManager
+// starts the queued files every frame
+class FakeTransport
+{
+public:
+    struct Result
+    {
+        milliseconds total_time{};
+        milliseconds mean_completion_time{};
+        std::vector<std::string> completion_order;
+    };
+
+private:
+    struct ActiveRequest
+    {
+        QueuedRequest request;
+        DownloadScheduler::time_point finish_time;
+    };
+
+    const size_t max_connections_ = 5;
+    const milliseconds frame_time_ = 10ms;
+    const milliseconds latency_ = 60ms;
+    const int bytes_per_second_ = 1024 * 1024;
+
+    // the number of attempts that fail before the file is downloaded
+    std::unordered_map<std::string, int> failures_;
+
+public:
+    void set_failures(const std::string& filename, int count) { failures_[filename] = count; }
+
+    Result Replay(DownloadSchedulePolicy policy, const std::vector<QueuedRequest>& manifest) const
+    {
+        DownloadScheduler scheduler;
+        scheduler.SetPolicy(policy);
+        for (const auto& request : manifest)
+            scheduler.Push(request);
+
+        auto failures = failures_;
+        std::vector<ActiveRequest> active_requests;
+        Result result;
+        milliseconds completion_time_sum{};
+
+        const DownloadScheduler::time_point start_time{};
+        DownloadScheduler::time_point now = start_time;
+
+        while (!scheduler.empty() || !active_requests.empty())
+        {
+            for (auto it = active_requests.begin(); it != active_requests.end();)
+            {
+                if (it->finish_time > now)
+                {
+                    ++it;
+                    continue;
+                }
+
+                const auto& descriptor = it->request.get_file_resource();
+                auto failure = failures.find(descriptor.filename);
+                if (failure != failures.end() && failure->second > 0)
+                {
+                    failure->second--;
+                    scheduler.PushRetry(QueuedRequest(descriptor, it->request.get_retry() + 1), now);
+                }
+                else
+                {
+                    auto completion_time = duration_cast<milliseconds>(now - start_time);
+                    completion_time_sum += completion_time;
+                    result.total_time = completion_time;
+                    result.completion_order.push_back(descriptor.filename);
+                }
+
+                it = active_requests.erase(it);
+            }
+
+            while (active_requests.size() < max_connections_)
+            {
+                const QueuedRequest* request = scheduler.Peek(now);
+                if (!request)
+                    break;
+
+                auto transfer_time = milliseconds(1000LL * request->get_file_resource().download_size / bytes_per_second_);
+                active_requests.push_back({*request, now + latency_ + transfer_time});
+                scheduler.Pop(now);
+            }
+
+            now += frame_time_;
+        }
+
+        if (!result.completion_order.empty())
+            result.mean_completion_time = completion_time_sum / (int64_t)result.completion_order.size();
+
+        return result;
+    }
+};
+
+// A server manifest in the order the server sends it: sounds, models and sprites, then the map files
+static std::vector<QueuedRequest> MakeManifest()
+{
+    std::vector<QueuedRequest> manifest;
+
+    for (int i = 0; i < 120; i++)
+        manifest.push_back(MakeRequest(std::format("sound/sound_{}.wav", i), 10 * 1024 + (i * 7919) % (50 * 1024)));
+
+    for (int i = 0; i < 24; i++)
+        manifest.push_back(MakeRequest(std::format("models/model_{}.mdl", i), 200 * 1024 + (i * 104729) % (600 * 1024)));
+
+    for (int i = 0; i < 6; i++)
+        manifest.push_back(MakeRequest(std::format("sprites/sprite_{}.spr", i), 2 * 1024));
+
+    manifest.push_back(MakeRequest("maps/de_test.wad", 3 * 1024 * 1024));
+    manifest.push_back(MakeRequest("maps/de_test.bsp", 6 * 1024 * 1024));
+
+    return manifest;
+}
+
+TEST(DownloadSchedulerTest, FifoKeepsPushOrder)
+{
+    std::vector<QueuedRequest> requests = { MakeRequest("a", 300), MakeRequest("b", 100), MakeRequest("c", 200), MakeRequest("d", 100) };
+
+    EXPECT_EQ(PopAll(DownloadSchedulePolicy::Fifo, requests), (std::vector<std::string>{ "a", "b", "c", "d" }));
+}
+
+TEST(DownloadSchedulerTest, LargestFirstOrdersBySizeDescending)
+{
+    std::vector<QueuedRequest> requests = { MakeRequest("a", 300), MakeRequest("b", 100), MakeRequest("c", 200), MakeRequest("d", 100) };
+
+    // files of the same size keep the push order
+    EXPECT_EQ(PopAll(DownloadSchedulePolicy::LargestFirst, requests), (std::vector<std::string>{ "a", "c", "b", "d" }));
+}
+
+TEST(DownloadSchedulerTest, SmallestFirstOrdersBySizeAscending)
+{
+    std::vector<QueuedRequest> requests = { MakeRequest("a", 300), MakeRequest("b", 100), MakeRequest("c", 200), MakeRequest("d", 100) };
+
+    EXPECT_EQ(PopAll(DownloadSchedulePolicy::SmallestFirst, requests), (std::vector<std::string>{ "b", "d", "c", "a" }));
+}
+
+TEST(DownloadSchedulerTest, PolicyIsChangedOnlyWhenEmpty)
+{
+    DownloadScheduler scheduler;
+    scheduler.Push(MakeRequest("a", 100));
+
+    EXPECT_FALSE(scheduler.SetPolicy(DownloadSchedulePolicy::LargestFirst));
+    EXPECT_EQ(scheduler.get_policy(), DownloadSchedulePolicy::Fifo);
+
+    scheduler.Clear();
+
+    EXPECT_TRUE(scheduler.SetPolicy(DownloadSchedulePolicy::LargestFirst));
+    EXPECT_EQ(scheduler.get_policy(), DownloadSchedulePolicy::LargestFirst);
+}
+
+TEST(DownloadSchedulerTest, RetryStaysBehindHealthyFiles)
+{
+    DownloadScheduler::time_point now{};
+    DownloadScheduler scheduler;
+    scheduler.SetPolicy(DownloadSchedulePolicy::SmallestFirst);
+
+    scheduler.PushRetry(MakeRequest("retry", 10, 1), now);
+    scheduler.Push(MakeRequest("a", 300));
+    scheduler.Push(MakeRequest("b", 200));
+
+    // the retry is ready but the healthy files are started first, even the larger ones
+    now += 10s;
+    EXPECT_EQ(PopAll(scheduler, now), (std::vector<std::string>{ "b", "a", "retry" }));
+    EXPECT_TRUE(scheduler.empty());
+}
+
+TEST(DownloadSchedulerTest, RetriesAreStartedByReadyTime)
+{
+    DownloadScheduler::time_point now{};
+    DownloadScheduler scheduler;
+
+    scheduler.PushRetry(MakeRequest("third_retry", 100, 3), now);
+    scheduler.PushRetry(MakeRequest("first_retry", 100, 1), now);
+    scheduler.PushRetry(MakeRequest("second_retry", 100, 2), now);
+
+    EXPECT_EQ(PopAll(scheduler, now + 10s), (std::vector<std::string>{ "first_retry", "second_retry", "third_retry" }));
+}
+
+TEST(DownloadSchedulerTest, RetryBackoffDoublesUpToLimit)
+{
+    const std::vector<std::pair<int, milliseconds>> expected_delays = {
+        { 1, 500ms }, { 2, 1s }, { 3, 2s }, { 4, 4s }, { 5, 8s }, { 6, 8s }, { 10, 8s },
+    };
+
+    for (const auto& [retry, delay] : expected_delays)
+    {
+        DownloadScheduler::time_point now{};
+        DownloadScheduler scheduler;
+        scheduler.PushRetry(MakeRequest("file", 100, retry), now);
+
+        EXPECT_EQ(scheduler.Peek(now + delay - 1ms), nullptr) << "retry " << retry;
+        scheduler.Pop(now + delay - 1ms);
+        EXPECT_EQ(scheduler.size(), 1) << "retry " << retry;
+
+        ASSERT_NE(scheduler.Peek(now + delay), nullptr) << "retry " << retry;
+        EXPECT_EQ(scheduler.Peek(now + delay)->get_retry(), retry);
+        scheduler.Pop(now + delay);
+        EXPECT_TRUE(scheduler.empty());
+    }
+}
+
+TEST(DownloadSchedulerTest, ManifestReplay)
+{
+    FakeTransport transport;
+    transport.set_failures("sound/sound_3.wav", 1);
+    transport.set_failures("sound/sound_70.wav", 1);
+    transport.set_failures("models/model_5.mdl", 2);
+
+    auto manifest = MakeManifest();
+    auto fifo = transport.Replay(DownloadSchedulePolicy::Fifo, manifest);
+    auto largest_first = transport.Replay(DownloadSchedulePolicy::LargestFirst, manifest);
+    auto smallest_first = transport.Replay(DownloadSchedulePolicy::SmallestFirst, manifest);
+
+    for (const auto& [name, result] : { std::pair{ "Fifo", &fifo }, std::pair{ "LargestFirst", &largest_first }, std::pair{ "SmallestFirst", &smallest_first } })
+    {
+        std::cout << std::format("[ BENCHMARK ] {} files, {}: {} ms total, {} ms mean completion\n",
+            manifest.size(), name, result->total_time.count(), result->mean_completion_time.count());
+        RecordProperty(std::string(name) + "_total_ms", (int)result->total_time.count());
+
+        EXPECT_EQ(result->completion_order.size(), manifest.size()) << name;
+    }
+
+    // the map files at the end of the manifest delay the whole download when they are started last
+    EXPECT_LT(largest_first.total_time, fifo.total_time);
+    // small files are usable earlier
+    EXPECT_LT(smallest_first.mean_completion_time, fifo.mean_completion_time);
+    EXPECT_LT(smallest_first.mean_completion_time, largest_first.mean_completion_time);
+}
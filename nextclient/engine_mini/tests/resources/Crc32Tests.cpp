@@ -0,0 +1,82 @@
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/Crc32.h"
+#include "ReferenceCrc32.h"
+
+static std::vector<uint8_t> MakeRandomBuffer(std::mt19937& random, size_t size)
+{
+    std::uniform_int_distribution<int> byte_distribution(0, 255);
+
+    std::vector<uint8_t> buffer(size);
+    for (auto& byte : buffer)
+        byte = (uint8_t)byte_distribution(random);
+
+    return buffer;
+}
+
+TEST(Crc32Test, MatchesCheckValue)
+{
+    std::string_view data = "123456789";
+
+    EXPECT_EQ(Crc32_Calc(data.data(), data.size()), 0xCBF43926);
+    EXPECT_EQ(Crc32_Calc(data.data(), 0), 0);
+}
+
+TEST(Crc32Test, MatchesReferenceOnRandomBuffers)
+{
+    std::mt19937 random(1);
+    std::uniform_int_distribution<size_t> size_distribution(0, 64 * 1024);
+
+    for (int i = 0; i < 200; i++)
+    {
+        auto buffer = MakeRandomBuffer(random, size_distribution(random));
+
+        ASSERT_EQ(Crc32_Calc(buffer.data(), buffer.size()), ReferenceCrc32(buffer.data(), buffer.size())) << "size " << buffer.size();
+    }
+}
+
+TEST(Crc32Test, MatchesReferenceOnUnalignedStartsAndTails)
+{
+    std::mt19937 random(2);
+    auto buffer = MakeRandomBuffer(random, 256);
+
+    // every start within an 8 byte block and every tail of 0-7 bytes after the 8 byte steps
+    for (size_t offset = 0; offset < 8; offset++)
+    {
+        for (size_t length = 0; length <= 64; length++)
+        {
+            const uint8_t* data = buffer.data() + offset;
+
+            ASSERT_EQ(Crc32_Calc(data, length), ReferenceCrc32(data, length)) << "offset " << offset << ", length " << length;
+        }
+    }
+}
+
+TEST(Crc32Test, ChainedCallsMatchSingleCall)
+{
+    std::mt19937 random(3);
+    std::uniform_int_distribution<size_t> size_distribution(0, 16 * 1024);
+
+    for (int i = 0; i < 100; i++)
+    {
+        auto buffer = MakeRandomBuffer(random, size_distribution(random));
+
+        // split at random points, the chunks start and end at any alignment
+        uint32_t crc_state = 0xFFFFFFFF;
+        size_t position = 0;
+        while (position < buffer.size())
+        {
+            std::uniform_int_distribution<size_t> chunk_distribution(0, std::min<size_t>(buffer.size() - position, 37));
+            size_t chunk_size = chunk_distribution(random);
+
+            crc_state = Crc32_ProcessBuffer(crc_state, buffer.data() + position, chunk_size);
+            position += chunk_size;
+        }
+
+        ASSERT_EQ(crc_state ^ 0xFFFFFFFF, ReferenceCrc32(buffer.data(), buffer.size())) << "size " << buffer.size();
+    }
+}
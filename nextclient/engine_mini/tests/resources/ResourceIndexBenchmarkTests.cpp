@@ -0,0 +1,166 @@
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "resource_index.h"
+#include "ReferenceCrc32.h"
+
+namespace fs = std::filesystem;
+
+static constexpr size_t kBenchmarkFilesCount = 3000;
+static constexpr size_t kBenchmarkMaxFileSize = 64 * 1024;
+
+class ResourceIndexBenchmarkTest : public ::testing::Test
+{
+protected:
+    fs::path test_dir_;
+
+    void SetUp() override
+    {
+        test_dir_ = fs::temp_directory_path() / "resource_index_benchmark_test";
+        fs::remove_all(test_dir_);
+        fs::create_directories(test_dir_);
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(test_dir_);
+    }
+
+    // Writes the files with random content and sizes, returns their paths and the total size
+    std::vector<std::string> CreateFiles(size_t count, size_t max_size, size_t& total_size)
+    {
+        std::mt19937 random(1);
+        std::uniform_int_distribution<size_t> size_distribution(1, max_size);
+        std::uniform_int_distribution<int> byte_distribution(0, 255);
+
+        std::vector<std::string> paths;
+        total_size = 0;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            // the resources are spread over folders as in the downloads folder
+            fs::path path = test_dir_ / std::format("folder_{}", i % 16) / std::format("file_{}.dat", i);
+            fs::create_directories(path.parent_path());
+
+            std::string content(size_distribution(random), '\0');
+            for (auto& byte : content)
+                byte = (char)byte_distribution(random);
+
+            std::ofstream file(path, std::ios::out | std::ios::binary);
+            file.write(content.data(), (std::streamsize)content.size());
+
+            paths.push_back(path.string());
+            total_size += content.size();
+        }
+
+        return paths;
+    }
+
+    template <typename Func>
+    static double MeasureMilliseconds(Func&& func)
+    {
+        auto start_time = std::chrono::steady_clock::now();
+        func();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    }
+};
+
+// The path ResDesc_CalcFileCRC32 used before the index: one file after another,
+// read whole into a buffer and hashed byte by byte
+static std::vector<CRC32_t> CalcFilesCRC32WithIfstream(const std::vector<std::string>& paths)
+{
+    std::vector<CRC32_t> result;
+    result.reserve(paths.size());
+
+    for (const auto& path : paths)
+    {
+        std::ifstream file(path, std::ifstream::in | std::ifstream::ate | std::ifstream::binary);
+        std::streamsize file_size = file.tellg();
+        file.seekg(0, std::ios::beg);
+
+        std::vector<char> file_buffer(file_size);
+        file.read(file_buffer.data(), file_size);
+
+        result.push_back(ReferenceCrc32(file_buffer.data(), file_buffer.size()));
+    }
+
+    return result;
+}
+
+TEST_F(ResourceIndexBenchmarkTest, CalcFilesCRC32)
+{
+    size_t total_size = 0;
+    auto paths = CreateFiles(kBenchmarkFilesCount, kBenchmarkMaxFileSize, total_size);
+
+    std::vector<CRC32_t> ifstream_result;
+    double ifstream_time = MeasureMilliseconds([&]() { ifstream_result = CalcFilesCRC32WithIfstream(paths); });
+
+    // the index is not loaded from disk, so the first call hashes every file
+    ResourceIndex index;
+    std::vector<std::string> errors;
+
+    std::vector<std::optional<CRC32_t>> cold_result;
+    double cold_time = MeasureMilliseconds([&]() { cold_result = index.CalcFilesCRC32(paths, errors); });
+
+    std::vector<std::optional<CRC32_t>> warm_result;
+    double warm_time = MeasureMilliseconds([&]() { warm_result = index.CalcFilesCRC32(paths, errors); });
+
+    ASSERT_EQ(cold_result.size(), paths.size());
+    ASSERT_EQ(warm_result.size(), paths.size());
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        ASSERT_TRUE(cold_result[i]) << paths[i];
+        ASSERT_TRUE(warm_result[i]) << paths[i];
+        EXPECT_EQ(*cold_result[i], ifstream_result[i]) << paths[i];
+        EXPECT_EQ(*warm_result[i], ifstream_result[i]) << paths[i];
+        EXPECT_TRUE(errors[i].empty()) << errors[i];
+    }
+
+    std::cout << std::format("[ BENCHMARK ] {} files, {:.1f} MB: {:.1f} ms with ifstream, {:.1f} ms mapped in parallel, {:.1f} ms indexed\n",
+                             paths.size(), total_size / (1024.0 * 1024.0), ifstream_time, cold_time, warm_time);
+    RecordProperty("ifstream_ms", (int)ifstream_time);
+    RecordProperty("mapped_parallel_ms", (int)cold_time);
+    RecordProperty("indexed_ms", (int)warm_time);
+}
+
+TEST_F(ResourceIndexBenchmarkTest, ChangedFileIsHashedAgain)
+{
+    size_t total_size = 0;
+    auto paths = CreateFiles(4, 1024, total_size);
+
+    ResourceIndex index;
+    std::vector<std::string> errors;
+    index.CalcFilesCRC32(paths, errors);
+
+    // the same size with another content and write time
+    std::string content(fs::file_size(paths[0]), 'x');
+    auto mtime = fs::last_write_time(paths[0]);
+    {
+        std::ofstream file(paths[0], std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(content.data(), (std::streamsize)content.size());
+    }
+    fs::last_write_time(paths[0], mtime + std::chrono::seconds(1));
+
+    std::string error;
+    auto crc32 = index.CalcFileCRC32(paths[0], error);
+
+    ASSERT_TRUE(crc32) << error;
+    EXPECT_EQ(*crc32, ReferenceCrc32(content.data(), content.size()));
+}
+
+TEST_F(ResourceIndexBenchmarkTest, MissingFileReturnsError)
+{
+    ResourceIndex index;
+    std::string error;
+
+    EXPECT_FALSE(index.CalcFileCRC32((test_dir_ / "missing.dat").string(), error));
+    EXPECT_FALSE(error.empty());
+}
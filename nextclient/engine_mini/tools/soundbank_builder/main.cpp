@@ -0,0 +1,252 @@
+// Builds the sound bank of a game directory: decodes the PCM .wav files under <directory>/sound
+// and packs them with their loop points into <directory>/sound.nsb, which the engine maps instead of
+// decoding the files one by one. Usage: soundbank_builder <directory> [output]
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Loaders/SoundBankFormat.hpp"
+
+using namespace MetaAudio;
+
+struct DecodedSound
+{
+    std::string name;
+    SoundBankEntry entry{};
+    std::vector<uint8_t> data;
+};
+
+static uint16_t ReadU16(const uint8_t* data)
+{
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static uint32_t ReadU32(const uint8_t* data)
+{
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static std::string NormalizeName(const std::filesystem::path& path)
+{
+    std::string result = path.generic_string();
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+    return result;
+}
+
+// Only the PCM files are packed, the loop points are taken from the cue points like libsndfile does in the engine
+static bool DecodeWave(const std::vector<uint8_t>& file, SoundBankEntry& entry, std::vector<uint8_t>& pcm)
+{
+    if (file.size() < 12 || std::memcmp(file.data(), "RIFF", 4) != 0 || std::memcmp(file.data() + 8, "WAVE", 4) != 0)
+        return false;
+
+    const uint8_t* format = nullptr;
+    const uint8_t* data = nullptr;
+    size_t data_size = 0;
+    const uint8_t* cues = nullptr;
+    size_t cues_size = 0;
+
+    size_t position = 12;
+    while (position + 8 <= file.size())
+    {
+        const uint8_t* chunk = file.data() + position;
+        size_t chunk_size = std::min<size_t>(ReadU32(chunk + 4), file.size() - position - 8);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16)
+        {
+            format = chunk + 8;
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0)
+        {
+            data = chunk + 8;
+            data_size = chunk_size;
+        }
+        else if (std::memcmp(chunk, "cue ", 4) == 0 && chunk_size >= 4)
+        {
+            cues = chunk + 8;
+            cues_size = chunk_size;
+        }
+
+        // the chunks are aligned to 2 bytes
+        position += 8 + chunk_size + (chunk_size & 1);
+    }
+
+    if (format == nullptr || data == nullptr)
+        return false;
+
+    uint16_t audio_format = ReadU16(format);
+    uint16_t channels = ReadU16(format + 2);
+    uint32_t samplerate = ReadU32(format + 4);
+    uint16_t block_align = ReadU16(format + 12);
+    uint16_t bits = ReadU16(format + 14);
+
+    if (audio_format != 1 || (channels != 1 && channels != 2) || (bits != 8 && bits != 16) || samplerate == 0)
+        return false;
+
+    if (block_align != channels * bits / 8)
+        return false;
+
+    entry.channels = channels;
+    entry.sample_type = (uint32_t)(bits == 8 ? SoundBankSampleType::UInt8 : SoundBankSampleType::Int16);
+    entry.samplerate = samplerate;
+    entry.frames = data_size / block_align;
+    entry.loop_start = 0;
+    entry.loop_end = std::numeric_limits<uint64_t>::max();
+
+    uint32_t cues_count = cues != nullptr ? std::min<size_t>(ReadU32(cues), (cues_size - 4) / 24) : 0;
+    if (cues_count > 0)
+    {
+        entry.has_loop_points = 1;
+        entry.loop_start = ReadU32(cues + 4 + 20);
+        if (cues_count > 1)
+            entry.loop_end = ReadU32(cues + 4 + 24 + 20);
+    }
+
+    pcm.assign(data, data + entry.frames * block_align);
+    return true;
+}
+
+static std::optional<DecodedSound> LoadSound(const std::filesystem::path& directory, const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return std::nullopt;
+
+    std::vector<uint8_t> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    DecodedSound sound;
+    if (!DecodeWave(contents, sound.entry, sound.data))
+        return std::nullopt;
+
+    std::error_code ec;
+    sound.entry.source_size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return std::nullopt;
+
+    sound.entry.source_mtime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    if (ec)
+        return std::nullopt;
+
+    sound.name = NormalizeName(std::filesystem::relative(path, directory, ec));
+    if (ec)
+        return std::nullopt;
+
+    return sound;
+}
+
+static uint64_t Align(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static bool WriteBank(const std::filesystem::path& output_path, std::vector<DecodedSound>& sounds)
+{
+    SoundBankHeader header{};
+    std::memcpy(header.magic, SoundBankHeader::MAGIC, sizeof(header.magic));
+    header.version = SoundBankHeader::VERSION;
+    header.entries_count = (uint32_t)sounds.size();
+    header.entries_offset = sizeof(SoundBankHeader);
+
+    uint64_t offset = header.entries_offset + sounds.size() * sizeof(SoundBankEntry);
+    for (auto& sound : sounds)
+    {
+        sound.entry.name_offset = offset;
+        sound.entry.name_length = (uint32_t)sound.name.size();
+        offset += sound.name.size();
+    }
+
+    for (auto& sound : sounds)
+    {
+        offset = Align(offset, 16);
+        sound.entry.data_offset = offset;
+        sound.entry.data_size = sound.data.size();
+        offset += sound.data.size();
+    }
+
+    auto temp_path = output_path;
+    temp_path += ".tmp";
+
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    file.write((const char*)&header, sizeof(header));
+    for (const auto& sound : sounds)
+        file.write((const char*)&sound.entry, sizeof(sound.entry));
+
+    for (const auto& sound : sounds)
+        file.write(sound.name.data(), (std::streamsize)sound.name.size());
+
+    for (const auto& sound : sounds)
+    {
+        auto padding = sound.entry.data_offset - (uint64_t)file.tellp();
+        for (uint64_t i = 0; i < padding; i++)
+            file.put(0);
+
+        file.write((const char*)sound.data.data(), (std::streamsize)sound.data.size());
+    }
+
+    file.close();
+    if (!file)
+        return false;
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, output_path, ec);
+    return !ec;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::printf("Usage: soundbank_builder <directory> [output]\n");
+        return 1;
+    }
+
+    std::filesystem::path directory = argv[1];
+    std::filesystem::path output_path = argc > 2 ? std::filesystem::path(argv[2]) : directory / SOUND_BANK_FILE_NAME;
+
+    std::error_code ec;
+    if (!std::filesystem::is_directory(directory / "sound", ec))
+    {
+        std::printf("%s has no sound directory\n", directory.string().c_str());
+        return 1;
+    }
+
+    std::vector<DecodedSound> sounds;
+    size_t skipped_count = 0;
+
+    for (const auto& file : std::filesystem::recursive_directory_iterator(directory / "sound", ec))
+    {
+        if (!file.is_regular_file() || NormalizeName(file.path().extension()) != ".wav")
+            continue;
+
+        if (auto sound = LoadSound(directory, file.path()))
+        {
+            sounds.push_back(std::move(sound.value()));
+        }
+        else
+        {
+            std::printf("Skipped %s: not a PCM file\n", file.path().string().c_str());
+            skipped_count++;
+        }
+    }
+
+    std::sort(sounds.begin(), sounds.end(), [](const auto& a, const auto& b) { return a.name < b.name; });
+
+    if (!WriteBank(output_path, sounds))
+    {
+        std::printf("Unable to write %s\n", output_path.string().c_str());
+        return 1;
+    }
+
+    std::printf("%s: %zu sounds packed, %zu skipped\n", output_path.string().c_str(), sounds.size(), skipped_count);
+    return 0;
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include "PatchEntry.h"
 #include "UpdaterJsonTraits.h"
 
 struct FileEntry
@@ -8,6 +10,8 @@ struct FileEntry
     std::string filename;
     std::string hash;
     size_t size{};
+    // optional, the patches from the previous versions of the file
+    std::vector<PatchEntry> patches;
 };
 
 template<>
@@ -20,6 +24,9 @@ struct UpdaterJsonTraits<FileEntry>
         result.filename = v.at("filename").template as<std::string>();
         result.hash = v.at("hash").template as<std::string>();
         result.size = v.at("size").template as<size_t>();
+
+        if (const auto* patches = v.find("patches"))
+            result.patches = patches->template as<std::vector<PatchEntry>>();
         return result;
     }
 };
\ No newline at end of file
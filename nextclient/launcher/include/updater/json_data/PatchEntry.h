@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include "UpdaterJsonTraits.h"
+
+// A delta patch which turns the file with base_hash into the current version of the file,
+// created with `zstd --patch-from=<base file> <new file>`
+struct PatchEntry
+{
+    std::string base_hash;
+    std::string filename;
+    size_t size{};
+};
+
+template<>
+struct UpdaterJsonTraits<PatchEntry>
+{
+    template<template<typename...> class Traits>
+    static PatchEntry as(const tao::json::basic_value<Traits>& v)
+    {
+        PatchEntry result;
+        result.base_hash = v.at("base_hash").template as<std::string>();
+        result.filename = v.at("filename").template as<std::string>();
+        result.size = v.at("size").template as<size_t>();
+        return result;
+    }
+};
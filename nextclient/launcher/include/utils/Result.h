@@ -69,6 +69,11 @@ public:
         return std::get<T>(value_);
     }
 
+    T& operator*()
+    {
+        return std::get<T>(value_);
+    }
+
     const T* operator->() const
     {
         return &std::get<T>(value_);
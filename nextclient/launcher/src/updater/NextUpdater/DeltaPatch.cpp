@@ -0,0 +1,49 @@
+#include "DeltaPatch.h"
+#include <format>
+#include <memory>
+#include <zstd.h>
+
+ResultT<std::vector<uint8_t>> ApplyDeltaPatch(const std::vector<uint8_t>& base, const std::vector<uint8_t>& patch, size_t expected_size)
+{
+    std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx(ZSTD_createDCtx(), ZSTD_freeDCtx);
+    if (dctx == nullptr)
+        return ResultError("ZSTD_createDCtx failed");
+
+    // the window of a patch covers the whole base file, it's larger than the default limit for big files
+    ZSTD_bounds window_log_bounds = ZSTD_dParam_getBounds(ZSTD_d_windowLogMax);
+    size_t result = ZSTD_DCtx_setParameter(dctx.get(), ZSTD_d_windowLogMax, window_log_bounds.upperBound);
+    if (ZSTD_isError(result))
+        return ResultError(std::format("ZSTD_d_windowLogMax: {}", ZSTD_getErrorName(result)));
+
+    result = ZSTD_DCtx_refPrefix(dctx.get(), base.data(), base.size());
+    if (ZSTD_isError(result))
+        return ResultError(std::format("ZSTD_DCtx_refPrefix: {}", ZSTD_getErrorName(result)));
+
+    // one more byte than expected to detect the larger results
+    std::vector<uint8_t> data(expected_size + 1);
+    ZSTD_inBuffer input{patch.data(), patch.size(), 0};
+    ZSTD_outBuffer output{data.data(), data.size(), 0};
+
+    while (input.pos < input.size)
+    {
+        result = ZSTD_decompressStream(dctx.get(), &output, &input);
+        if (ZSTD_isError(result))
+            return ResultError(std::format("ZSTD_decompressStream: {}", ZSTD_getErrorName(result)));
+
+        if (output.pos == output.size)
+            return ResultError(std::format("patched file is larger than {} bytes", expected_size));
+
+        // the frame is complete
+        if (result == 0)
+            break;
+    }
+
+    if (result != 0)
+        return ResultError("patch is truncated");
+
+    if (output.pos != expected_size)
+        return ResultError(std::format("patched file size is {} bytes, expected {}", output.pos, expected_size));
+
+    data.resize(output.pos);
+    return data;
+}
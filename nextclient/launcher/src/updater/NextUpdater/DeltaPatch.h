@@ -0,0 +1,10 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utils/Result.h>
+
+// Applies a patch created with `zstd --patch-from=<base file> <new file>`: the patch is a zstd frame
+// which uses the base file as its prefix. The decompression stops with an error if the result
+// would be larger than expected_size.
+ResultT<std::vector<uint8_t>> ApplyDeltaPatch(const std::vector<uint8_t>& base, const std::vector<uint8_t>& patch, size_t expected_size);
@@ -0,0 +1,90 @@
+#include "FileHashCache.h"
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+// md5, size, mtime and path separated by spaces on each line, the path is the last since it may contain spaces
+static constexpr char kCacheHeader[] = "file_hash_cache 1";
+// the md5 of an empty file is stored as this, since the hash of an empty file is an empty string
+static constexpr char kEmptyHash[] = "-";
+
+FileHashCache::FileHashCache(std::filesystem::path cache_path) :
+    cache_path_(std::move(cache_path))
+{ }
+
+void FileHashCache::Load()
+{
+    entries_.clear();
+    is_dirty_ = false;
+
+    std::ifstream file(cache_path_);
+    if (!file.is_open())
+        return;
+
+    std::string line;
+    if (!std::getline(file, line) || line != kCacheHeader)
+        return;
+
+    while (std::getline(file, line))
+    {
+        std::istringstream line_stream(line);
+
+        Entry entry{};
+        line_stream >> entry.md5 >> entry.size >> entry.mtime;
+        if (!line_stream || line_stream.get() != ' ')
+            continue;
+
+        std::string path;
+        std::getline(line_stream, path);
+        if (path.empty())
+            continue;
+
+        if (entry.md5 == kEmptyHash)
+            entry.md5.clear();
+
+        entries_[path] = std::move(entry);
+    }
+}
+
+void FileHashCache::Save()
+{
+    if (!is_dirty_)
+        return;
+
+    std::error_code ec;
+    if (cache_path_.has_parent_path())
+        fs::create_directories(cache_path_.parent_path(), ec);
+
+    std::ofstream file(cache_path_, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return;
+
+    file << kCacheHeader << '\n';
+    for (const auto& [path, entry] : entries_)
+        file << (entry.md5.empty() ? kEmptyHash : entry.md5) << ' ' << entry.size << ' ' << entry.mtime << ' ' << path << '\n';
+
+    if (file)
+        is_dirty_ = false;
+}
+
+std::optional<std::string> FileHashCache::Find(const std::filesystem::path& path, uint64_t size, int64_t mtime) const
+{
+    auto it = entries_.find(path.generic_string());
+    if (it == entries_.end() || it->second.size != size || it->second.mtime != mtime)
+        return std::nullopt;
+
+    return it->second.md5;
+}
+
+void FileHashCache::Update(const std::filesystem::path& path, uint64_t size, int64_t mtime, std::string md5)
+{
+    entries_[path.generic_string()] = {size, mtime, std::move(md5)};
+    is_dirty_ = true;
+}
+
+void FileHashCache::Remove(const std::filesystem::path& path)
+{
+    if (entries_.erase(path.generic_string()) != 0)
+        is_dirty_ = true;
+}
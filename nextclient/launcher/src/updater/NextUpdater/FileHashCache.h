@@ -0,0 +1,37 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+// Persistent cache of the MD5 of the installed files, keyed by path.
+// An entry is valid while the size and the last write time of the file are unchanged,
+// so the files are hashed again only after they are modified.
+class FileHashCache
+{
+    struct Entry
+    {
+        uint64_t size;
+        int64_t mtime;
+        std::string md5;
+    };
+
+    std::filesystem::path cache_path_;
+    std::unordered_map<std::string, Entry> entries_;
+    bool is_dirty_ = false;
+
+public:
+    explicit FileHashCache(std::filesystem::path cache_path);
+
+    void Load();
+    // Writes the cache to disk if it has changed since it was loaded
+    void Save();
+
+    [[nodiscard]] std::optional<std::string> Find(const std::filesystem::path& path, uint64_t size, int64_t mtime) const;
+    void Update(const std::filesystem::path& path, uint64_t size, int64_t mtime, std::string md5);
+    void Remove(const std::filesystem::path& path);
+
+    [[nodiscard]] size_t size() const { return entries_.size(); }
+};
@@ -1,15 +1,26 @@
 #include "NextUpdater.h"
 #include <chrono>
 #include <utility>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <iterator>
 #include <nitro_utils/string_utils.h>
 #include <data_encoding/md5.h>
 #include <utils/platform.h>
 #include "http_download/HttpFileDownloader.h"
+#include "DeltaPatch.h"
 
 using namespace std::chrono;
 using namespace std::chrono_literals;
 namespace fs = std::filesystem;
 
+static const fs::path kHashCacheFilename = fs::path("update") / "file_hashes_v1.txt";
+static constexpr size_t kHashBufferSize = 256 * 1024;
+static constexpr unsigned int kMaxHashWorkers = 8;
+// the folder in the backup folder where the files are downloaded before they are installed
+static constexpr auto kStagingFolderName = "staging";
+
 NextUpdater::NextUpdater(std::filesystem::path install_path,
                          std::filesystem::path backup_path,
                          el::Logger* logger,
@@ -44,7 +55,11 @@ NextUpdaterResult NextUpdater::Start()
 
     SetStateAndRaiseEvent(NextUpdaterState::GatheringFilesToUpdate);
     logger_->info("Gathering files that need to be updated");
-    ResultT<std::unordered_map<std::string, UpdaterFileInfo>> files_to_update = GetFilesToUpdate(file_infos);
+    FileHashCache hash_cache(install_path_ / kHashCacheFilename);
+    hash_cache.Load();
+
+    size_t hashed_files_count = 0;
+    ResultT<std::unordered_map<std::string, UpdaterFileInfo>> files_to_update = GetFilesToUpdate(file_infos, hash_cache, hashed_files_count);
     if (files_to_update.has_error())
     {
         logger_->error("Gathering files to update error: %v", files_to_update.get_error());
@@ -52,6 +67,9 @@ NextUpdaterResult NextUpdater::Start()
         return NextUpdaterResult::Error;
     }
 
+    logger_->info("  hashed %v of %v files, the others are unchanged since the last check", hashed_files_count, file_infos.size());
+    hash_cache.Save();
+
     if (files_to_update->empty())
     {
         logger_->info("  nothing to update");
@@ -94,7 +112,7 @@ NextUpdaterResult NextUpdater::Start()
     logger_->info("  base url: %v", update_entry->hostname);
 #endif
     SetStateAndRaiseEvent(NextUpdaterState::Downloading);
-    ResultT<std::vector<HttpFileResult>> download_results = DownloadFilesToUpdate(*files_to_update | std::views::values, update_entry->hostname,
+    ResultT<std::vector<HttpFileResult>> download_results = DownloadFilesToUpdate(*files_to_update | std::views::values, update_entry->hostname, backup_path_ / kStagingFolderName,
         [this](cpr::cpr_off_t total, cpr::cpr_off_t downloaded, cpr::cpr_off_t speed) {
             SetStateProgressAndRaiseEvent((float)downloaded / (float)total);
             return canceled_.load();
@@ -267,22 +285,78 @@ ResultT<UpdateEntry> NextUpdater::SendUpdateFilesRequest()
     }
 }
 
-ResultT<std::vector<HttpFileResult>> NextUpdater::DownloadFilesToUpdate(auto files, const std::string& hostname, std::function<bool(cpr::cpr_off_t total, cpr::cpr_off_t downloaded, cpr::cpr_off_t speed)> progress)
+ResultT<std::vector<HttpFileResult>> NextUpdater::DownloadFilesToUpdate(auto files, const std::string& hostname, const fs::path& staging_path, std::function<bool(cpr::cpr_off_t total, cpr::cpr_off_t downloaded, cpr::cpr_off_t speed)> progress)
 {
     std::vector<HttpFileRequest> files_to_download;
+    std::vector<HttpFileRequest> patches_to_download;
+    // key is patch file name
+    std::unordered_map<std::string, const UpdaterFileInfo*> patched_files;
     cpr::cpr_off_t total_bytes_to_download = 0;
 
     for (const auto& file: files)
     {
         auto file_entry = file.get_remote_file();
+
+        if (const PatchEntry* patch = FindPatch(file))
+        {
+            patches_to_download.emplace_back(HttpFileRequest(patch->filename, "", patch->size));
+            patched_files.emplace(patch->filename, &file);
+            total_bytes_to_download += patch->size;
+            continue;
+        }
+
         files_to_download.emplace_back(HttpFileRequest(file_entry.filename, file_entry.hash, file_entry.size));
         total_bytes_to_download += file.get_remote_file().size;
     }
 
-    HttpFileDownloader downloader(files_to_download, hostname, [total_bytes_to_download, progress](cpr::cpr_off_t downloaded, cpr::cpr_off_t speed) {
-        return progress(total_bytes_to_download, downloaded, speed);
-    });
-    std::vector<HttpFileResult> download_results = downloader.StartDownloads();
+    std::vector<HttpFileResult> download_results;
+    cpr::cpr_off_t patches_bytes_downloaded = 0;
+
+    if (!patches_to_download.empty())
+    {
+        HttpFileDownloader patch_downloader(patches_to_download, hostname, [&total_bytes_to_download, &patches_bytes_downloaded, progress](cpr::cpr_off_t downloaded, cpr::cpr_off_t speed) {
+            patches_bytes_downloaded = downloaded;
+            return progress(total_bytes_to_download, downloaded, speed);
+        }, staging_path);
+
+        for (const auto& patch_result : patch_downloader.StartDownloads())
+        {
+            const UpdaterFileInfo& file = *patched_files.at(patch_result.get_request().get_filename());
+            const FileEntry& file_entry = file.get_remote_file();
+
+            ResultT<fs::path> patched_path = patch_result.has_error()
+                ? ResultT<fs::path>(ResultError("download error: " + patch_result.get_error()))
+                : ApplyPatch(file, patch_result.get_staged_path(), staging_path);
+
+            if (patched_path.has_error())
+            {
+                LOG(WARNING) << "NextUpdater::DownloadFilesToUpdate | " << file_entry.filename << ": patch is not applied, downloading the full file: " << patched_path.get_error();
+
+                files_to_download.emplace_back(HttpFileRequest(file_entry.filename, file_entry.hash, file_entry.size));
+                total_bytes_to_download += file_entry.size;
+                continue;
+            }
+
+            download_results.emplace_back(HttpFileRequest(file_entry.filename, file_entry.hash, file_entry.size), std::move(*patched_path));
+        }
+
+        if (progress(total_bytes_to_download, patches_bytes_downloaded, 0))
+            return download_results;
+    }
+
+    if (!files_to_download.empty())
+    {
+        HttpFileDownloader downloader(files_to_download, hostname, [total_bytes_to_download, patches_bytes_downloaded, progress](cpr::cpr_off_t downloaded, cpr::cpr_off_t speed) {
+            return progress(total_bytes_to_download, patches_bytes_downloaded + downloaded, speed);
+        }, staging_path);
+
+        for (auto& result : downloader.StartDownloads())
+            download_results.emplace_back(std::move(result));
+
+        LOG(INFO) << "NextUpdater::DownloadFilesToUpdate | downloaded " << downloader.get_payload_bytes() << " bytes, received " << downloader.get_received_bytes() << " bytes";
+        if (downloader.is_connection_reuse_disabled())
+            LOG(WARNING) << "NextUpdater::DownloadFilesToUpdate | the host stalled the reused connections, the files were requested on new connections";
+    }
 
     std::string error_str;
     for (const auto& file: download_results)
@@ -298,27 +372,172 @@ ResultT<std::vector<HttpFileResult>> NextUpdater::DownloadFilesToUpdate(auto fil
     return download_results;
 }
 
-ResultT<std::unordered_map<std::string, UpdaterFileInfo>> NextUpdater::GetFilesToUpdate(const std::vector<UpdaterFileInfo>& files)
+const PatchEntry* NextUpdater::FindPatch(const UpdaterFileInfo& file)
+{
+    if (file.get_local_hash().empty())
+        return nullptr;
+
+    for (const auto& patch : file.get_remote_file().patches)
+    {
+        if (patch.base_hash == file.get_local_hash())
+            return &patch;
+    }
+
+    return nullptr;
+}
+
+ResultT<fs::path> NextUpdater::ApplyPatch(const UpdaterFileInfo& file, const fs::path& patch_path, const fs::path& staging_path)
+{
+    // the install file is already truncated, its previous content is in the backup
+    const fs::path& base_path = file.is_need_backup() ? file.get_backup_path() : file.get_to_hash_path();
+
+    // zstd needs the whole base as the prefix, so the base and the patch are read into memory
+    ResultT<std::vector<uint8_t>> base_data = ReadFileData(base_path);
+    if (base_data.has_error())
+        return ResultError(base_data.get_error());
+
+    ResultT<std::vector<uint8_t>> patch_data = ReadFileData(patch_path);
+    if (patch_data.has_error())
+        return ResultError(patch_data.get_error());
+
+    const FileEntry& file_entry = file.get_remote_file();
+    ResultT<std::vector<uint8_t>> patched_data = ApplyDeltaPatch(*base_data, *patch_data, file_entry.size);
+    if (patched_data.has_error())
+        return ResultError(patched_data.get_error());
+
+    StagingFile patched_file(staging_path / (file_entry.filename + ".part"));
+    Result open_result = patched_file.Open();
+    if (open_result.has_error())
+        return ResultError(open_result.get_error());
+
+    patched_file.Write(reinterpret_cast<const char*>(patched_data->data()), patched_data->size());
+
+    ResultT<std::string> patched_hash = patched_file.Finish();
+    if (patched_hash.has_error())
+        return ResultError(patched_hash.get_error());
+
+    if (*patched_hash != file_entry.hash)
+        return ResultError(std::format("patched file hash {} doesn't match {}", *patched_hash, file_entry.hash));
+
+    return fs::path(patched_file.get_path());
+}
+
+ResultT<std::unordered_map<std::string, UpdaterFileInfo>> NextUpdater::GetFilesToUpdate(const std::vector<UpdaterFileInfo>& files, FileHashCache& hash_cache, size_t& hashed_files_count)
 {
-    FileOpener fo(std::ios::in | std::ios::binary);
-    for (const auto& item: files)
-        fo.OpenFile(item.get_to_hash_path());
+    struct LocalFileHash
+    {
+        bool has_write_info = false;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        bool is_exists = false;
+        std::string md5;
+        std::string error;
+    };
+
+    std::vector<LocalFileHash> hashes(files.size());
+    std::vector<size_t> files_to_hash;
+
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        const fs::path& path = files[i].get_to_hash_path();
+        LocalFileHash& hash = hashes[i];
+
+        std::error_code ec_size;
+        std::error_code ec_write_time;
+        uint64_t size = fs::file_size(path, ec_size);
+        fs::file_time_type write_time = fs::last_write_time(path, ec_write_time);
+
+        // the missing files and the errors are reported by the opener
+        if (!ec_size && !ec_write_time)
+        {
+            hash.has_write_info = true;
+            hash.size = size;
+            hash.mtime = write_time.time_since_epoch().count();
+
+            if (auto cached_md5 = hash_cache.Find(path, hash.size, hash.mtime))
+            {
+                hash.is_exists = true;
+                hash.md5 = std::move(*cached_md5);
+                continue;
+            }
+        }
+
+        files_to_hash.push_back(i);
+    }
+
+    // the files are read with a fixed buffer per thread, so the memory use doesn't depend on the file sizes
+    std::atomic_size_t next_file_to_hash = 0;
+    auto hash_files = [&files, &hashes, &files_to_hash, &next_file_to_hash]
+    {
+        std::vector<char> buffer(kHashBufferSize);
+
+        for (size_t index = next_file_to_hash++; index < files_to_hash.size(); index = next_file_to_hash++)
+        {
+            const fs::path& path = files[files_to_hash[index]].get_to_hash_path();
+            LocalFileHash& hash = hashes[files_to_hash[index]];
+
+            OpenerFile file = FileOpener::OpenSingleFile(path, std::ios::in | std::ios::binary);
+            if (file.HasError(FileOpenerErrorFlags::IgnoreNotExists))
+            {
+                hash.error = FileOpener::CreateErrorMessage(file, path);
+                continue;
+            }
+
+            hash.is_exists = file.IsFileExists();
+            if (!hash.is_exists)
+                continue;
+
+            errno = 0;
+            hash.md5 = GetStreamMd5(file.stream, buffer);
+            if (file.stream.bad())
+                hash.error = FileOpener::CreateErrorMessage(file.stream, path);
+        }
+    };
+
+    unsigned int workers_count = std::clamp(std::thread::hardware_concurrency(), 1u, kMaxHashWorkers);
+    workers_count = std::min(workers_count, (unsigned int)files_to_hash.size());
+
+    if (workers_count > 0)
+    {
+        // the calling thread is one of the workers, the others are joined at the end of the scope
+        std::vector<std::jthread> workers;
+        for (unsigned int i = 1; i < workers_count; i++)
+            workers.emplace_back(hash_files);
+
+        hash_files();
+    }
+
+    hashed_files_count = files_to_hash.size();
 
     std::string open_files_error;
-    if (!fo.IsAllFilesOpened(FileOpenerErrorFlags::IgnoreNotExists, open_files_error))
+    for (size_t index : files_to_hash)
+    {
+        const fs::path& path = files[index].get_to_hash_path();
+        const LocalFileHash& hash = hashes[index];
+
+        if (!hash.error.empty())
+            open_files_error += hash.error + "\n";
+        else if (!hash.is_exists)
+            hash_cache.Remove(path);
+        else if (hash.has_write_info)
+            hash_cache.Update(path, hash.size, hash.mtime, hash.md5);
+    }
+
+    if (!open_files_error.empty())
         return ResultError("Open files error: " + open_files_error);
 
     std::unordered_map<std::string, UpdaterFileInfo> files_to_update;
-    for (const auto& file : files)
+    for (size_t i = 0; i < files.size(); i++)
     {
-        auto& file_info = fo.GetFileInfo(file.get_to_hash_path());
+        const UpdaterFileInfo& file = files[i];
+        const LocalFileHash& hash = hashes[i];
 
-        if (!file_info.IsFileExists() || file.get_remote_file().hash != GetStreamMd5(file_info.stream))
+        if (!hash.is_exists || file.get_remote_file().hash != hash.md5)
         {
             std::string remote_filename = file.get_remote_file().filename;
-            bool need_backup = remote_filename != "cs.exe" && file_info.IsFileExists();
+            bool need_backup = remote_filename != "cs.exe" && hash.is_exists;
 
-            UpdaterFileInfo file_result(file.get_to_hash_path(), file.get_install_path(), file.get_backup_path(), file.get_remote_file(), need_backup);
+            UpdaterFileInfo file_result(file.get_to_hash_path(), file.get_install_path(), file.get_backup_path(), file.get_remote_file(), need_backup, hash.md5);
             files_to_update.emplace(remote_filename, std::move(file_result));
         }
     }
@@ -334,11 +553,34 @@ Result NextUpdater::InstallFiles(FileOpener& file_opener, const std::vector<Http
         const UpdaterFileInfo& updater_file = updating_file_info.at(download_result.get_request().get_filename());
         std::fstream& install_stream = file_opener.GetFileInfo(updater_file.get_install_path()).stream;
 
-        if (download_result.get_data().empty())
-            continue;
+        if (download_result.is_staged())
+        {
+            // the install files are kept opened and locked until the end of the update, so the staged file is copied instead of moved
+            OpenerFile staged_file = FileOpener::OpenSingleFile(download_result.get_staged_path(), std::ios::in | std::ios::binary);
+            if (staged_file.HasError())
+            {
+                error += std::format("at staged path: {}\n", FileOpener::CreateErrorMessage(staged_file, download_result.get_staged_path()));
+                continue;
+            }
+
+            if (staged_file.IsEmptyOrFullRead())
+                continue;
+
+            errno = 0;
+            install_stream << staged_file.stream.rdbuf();
+
+            if (FileOpener::IsError(staged_file.stream))
+                error += std::format("at staged path: {}\n", FileOpener::CreateErrorMessage(staged_file.stream, download_result.get_staged_path()));
+        }
+        else
+        {
+            if (download_result.get_data().empty())
+                continue;
+
+            errno = 0;
+            install_stream.write(reinterpret_cast<const char*>(download_result.get_data().data()), download_result.get_data().size());
+        }
 
-        errno = 0;
-        install_stream.write(reinterpret_cast<const char*>(download_result.get_data().data()), download_result.get_data().size());
         install_stream.flush();
 
         if (FileOpener::IsError(install_stream))
@@ -443,8 +685,17 @@ ResultT<int> NextUpdater::RestoreFilesFromBackup()
     fs::path root_path = GetCurrentProcessDirectory();
 
     std::vector<UpdaterFileInfo> updater_files;
-    for (const fs::directory_entry& dir_entry : dir_it)
+    for (; dir_it != fs::recursive_directory_iterator(); ++dir_it)
     {
+        const fs::directory_entry& dir_entry = *dir_it;
+
+        // the downloads of an interrupted update aren't backups
+        if (dir_it.depth() == 0 && dir_entry.path().filename() == kStagingFolderName)
+        {
+            dir_it.disable_recursion_pending();
+            continue;
+        }
+
         if (!dir_entry.is_regular_file())
             continue;
 
@@ -507,21 +758,33 @@ ResultT<int> NextUpdater::RestoreFilesFromBackup(auto files)
     return restored_files_count;
 }
 
-std::string NextUpdater::GetStreamMd5(std::fstream& stream)
+std::string NextUpdater::GetStreamMd5(std::istream& stream, std::vector<char>& buffer)
 {
-    stream.seekg(0, std::ifstream::end);
-    size_t length = stream.tellg();
-    stream.seekg(0, std::ifstream::beg);
+    MD5 md5;
+    size_t length = 0;
+
+    while (stream.read(buffer.data(), (std::streamsize)buffer.size()) || stream.gcount() > 0)
+    {
+        md5.update(buffer.data(), (size_t)stream.gcount());
+        length += (size_t)stream.gcount();
+    }
 
-    std::vector<char> buffer;
     if (length == 0)
         return "";
 
-    buffer.resize(length);
-    stream.read(buffer.data(), length);
-
-    MD5 md5;
-    md5.update(buffer.data(), buffer.size());
     md5.finalize();
     return md5.hexdigest();
 }
+
+ResultT<std::vector<uint8_t>> NextUpdater::ReadFileData(const fs::path& path)
+{
+    OpenerFile file = FileOpener::OpenSingleFile(path, std::ios::in | std::ios::binary);
+    if (file.HasError())
+        return ResultError(FileOpener::CreateErrorMessage(file, path));
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file.stream)), std::istreambuf_iterator<char>());
+    if (FileOpener::IsError(file.stream) && !file.stream.eof())
+        return ResultError(FileOpener::CreateErrorMessage(file.stream, path));
+
+    return data;
+}
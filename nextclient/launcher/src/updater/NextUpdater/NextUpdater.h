@@ -12,6 +12,7 @@
 #include "NextUpdaterHttpService.h"
 #include "http_download/HttpFileResult.h"
 #include "FileOpener.h"
+#include "FileHashCache.h"
 #include "UpdaterFileInfo.h"
 
 enum class NextUpdaterResult
@@ -67,8 +68,14 @@ private:
     ResultT<UpdateEntry> SendUpdateFilesRequest();
     std::vector<UpdaterFileInfo> CreateUpdaterFileInfos(const std::vector<FileEntry>& remote_files);
     // key is remote file name
-    static ResultT<std::unordered_map<std::string, UpdaterFileInfo>> GetFilesToUpdate(const std::vector<UpdaterFileInfo>& files);
-    static ResultT<std::vector<HttpFileResult>> DownloadFilesToUpdate(auto files, const std::string& hostname, std::function<bool(cpr::cpr_off_t total, cpr::cpr_off_t downloaded, cpr::cpr_off_t speed)> progress);
+    // the files with unchanged size and write time in hash_cache aren't read, the others are hashed on several threads
+    static ResultT<std::unordered_map<std::string, UpdaterFileInfo>> GetFilesToUpdate(const std::vector<UpdaterFileInfo>& files, FileHashCache& hash_cache, size_t& hashed_files_count);
+    // the files with a patch for the installed version are patched, the others and the failed patches are downloaded in full
+    // the results are staged in staging_path, so only one file is in memory at a time (when it's patched)
+    static ResultT<std::vector<HttpFileResult>> DownloadFilesToUpdate(auto files, const std::string& hostname, const std::filesystem::path& staging_path, std::function<bool(cpr::cpr_off_t total, cpr::cpr_off_t downloaded, cpr::cpr_off_t speed)> progress);
+    static const PatchEntry* FindPatch(const UpdaterFileInfo& file);
+    // returns the path of the staged patched file
+    static ResultT<std::filesystem::path> ApplyPatch(const UpdaterFileInfo& file, const std::filesystem::path& patch_path, const std::filesystem::path& staging_path);
 
     static Result InstallFiles(FileOpener& file_opener, const std::vector<HttpFileResult>& downloaded_files, const std::unordered_map<std::string, UpdaterFileInfo>& updating_file_info);
 
@@ -79,5 +86,6 @@ private:
     ResultT<int> RestoreFilesFromBackup();
 
     // utils
-    static std::string GetStreamMd5(std::fstream& stream);
+    static std::string GetStreamMd5(std::istream& stream, std::vector<char>& buffer);
+    static ResultT<std::vector<uint8_t>> ReadFileData(const std::filesystem::path& path);
 };
@@ -10,14 +10,17 @@ class UpdaterFileInfo
     std::filesystem::path backup_path_;
     FileEntry remote_file_;
     bool need_backup_;
+    // md5 of the installed file, empty if it doesn't exist
+    std::string local_hash_;
 
 public:
-    explicit UpdaterFileInfo(std::filesystem::path to_hash_path, std::filesystem::path install_path, std::filesystem::path backup_path, FileEntry remote_file, bool need_backup) :
+    explicit UpdaterFileInfo(std::filesystem::path to_hash_path, std::filesystem::path install_path, std::filesystem::path backup_path, FileEntry remote_file, bool need_backup, std::string local_hash = {}) :
             to_hash_path_(std::move(to_hash_path)),
             install_path_(std::move(install_path)),
             backup_path_(std::move(backup_path)),
             remote_file_(std::move(remote_file)),
-            need_backup_(need_backup)
+            need_backup_(need_backup),
+            local_hash_(std::move(local_hash))
     { }
 
     [[nodiscard]] const std::filesystem::path& get_to_hash_path() const { return to_hash_path_; }
@@ -25,4 +28,5 @@ public:
     [[nodiscard]] const std::filesystem::path& get_backup_path() const { return backup_path_; }
     [[nodiscard]] const FileEntry& get_remote_file() const { return remote_file_; }
     [[nodiscard]] bool is_need_backup() const { return need_backup_; }
+    [[nodiscard]] const std::string& get_local_hash() const { return local_hash_; }
 };
\ No newline at end of file
@@ -1,66 +1,118 @@
 #include "HttpFileDownloader.h"
 #include <chrono>
+#include <format>
+#include <numeric>
 #include <nitro_utils/string_utils.h>
 
 using namespace std::chrono;
 using namespace std::chrono_literals;
 
-HttpFileDownloader::HttpFileDownloader(const std::vector<HttpFileRequest>& files, const std::string& base_url, const std::function<bool(cpr::cpr_off_t downloaded, cpr::cpr_off_t speed)>& progress) :
-    progress_(progress)
+HttpFileDownloader::HttpFileDownloader(const std::vector<HttpFileRequest>& files, const std::string& base_url, const std::function<bool(cpr::cpr_off_t downloaded, cpr::cpr_off_t speed)>& progress, std::filesystem::path staging_path) :
+    staging_path_(std::move(staging_path)),
+    progress_(progress),
+    multi_(curl_multi_init())
 {
     base_url_ = FixUrl(base_url);
 
     for (const auto& file : files)
         files_to_download_.emplace(file, 0);
+
+    // the requests to the same host share the connections instead of opening a new one per file
+    curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, (long)max_active_requests_);
+}
+
+HttpFileDownloader::~HttpFileDownloader()
+{
+    CancelDownloads();
+    curl_multi_cleanup(multi_);
 }
 
 std::vector<HttpFileResult> HttpFileDownloader::StartDownloads()
 {
     bool terminate = false;
+    auto last_progress_time = steady_clock::time_point{};
+
+    StartNewDownloads();
 
     while (true)
     {
+        int running_handles = 0;
+        curl_multi_perform(multi_, &running_handles);
+
         PruneCompletedRequests();
         StartNewDownloads();
-        UpdateTransferStatistics();
 
-        if (!terminate)
+        bool is_completed = CheckAllDownloadsCompleted();
+
+        auto current_time = steady_clock::now();
+        if (is_completed || current_time - last_progress_time >= progress_interval_)
         {
-            terminate = progress_(transfer_statistics_.get_downloaded_bytes(), transfer_statistics_.get_speed());
-            if (terminate)
-                CancelDownloads();
+            last_progress_time = current_time;
+            UpdateTransferStatistics();
+
+            if (!terminate)
+            {
+                terminate = progress_(GetPayloadBytes(), transfer_statistics_.get_speed());
+                if (terminate)
+                {
+                    CancelDownloads();
+                    is_completed = true;
+                }
+            }
         }
 
-        if (CheckAllDownloadsCompleted())
+        if (is_completed)
             return results_;
 
-        std::this_thread::sleep_for(10ms);
+        // sleeps until a transfer has data or a new download can start
+        curl_multi_poll(multi_, nullptr, 0, (int)progress_interval_.count(), nullptr);
     }
 }
 
 void HttpFileDownloader::PruneCompletedRequests()
 {
-    for (auto it = requests_.begin(); it != requests_.end(); )
+    int messages_left = 0;
+
+    while (CURLMsg* message = curl_multi_info_read(multi_, &messages_left))
     {
-        auto& request_ctx = *it;
+        if (message->msg != CURLMSG_DONE)
+            continue;
 
-        if (request_ctx.get_response().wait_for(0s) != std::future_status::ready)
-        {
-            ++it;
+        // the message is freed by curl_multi_remove_handle
+        CURL* easy = message->easy_handle;
+        CURLcode result = message->data.result;
+
+        auto it = std::find_if(requests_.begin(), requests_.end(), [easy](const auto& request_ctx) { return request_ctx->get_easy() == easy; });
+        if (it == requests_.end())
             continue;
-        }
 
+        auto& request_ctx = **it;
         const HttpFileRequest& request = request_ctx.get_request();
 
-        cpr::Response response = request_ctx.get_response().get();
-        std::string error_message = ValidateResponseAndGetErrorMessage(response);
+        std::string error_message = ValidateResponseAndGetErrorMessage(result, request_ctx);
+
+        StagingFile* staging_file = request_ctx.get_staging_file();
+        if (staging_file)
+        {
+            std::string staging_error_message = FinishStagingFileAndGetErrorMessage(*staging_file, request);
+            if (error_message.empty())
+                error_message = std::move(staging_error_message);
+        }
 
         if (error_message.empty())
         {
-            std::vector<uint8_t> data(response.text.data(), response.text.data() + response.text.size());
-            results_.emplace_back(request, std::move(data));
+            completed_requests_payload_bytes_ += request_ctx.get_payload_now();
 
-            completed_requests_bytes_downloaded_ += response.downloaded_bytes;
+            if (staging_file)
+                results_.emplace_back(request, staging_file->get_path());
+            else
+                results_.emplace_back(request, std::move(request_ctx.get_data()));
+
+            curl_off_t received_bytes = 0;
+            curl_easy_getinfo(easy, CURLINFO_SIZE_DOWNLOAD_T, &received_bytes);
+            completed_requests_bytes_downloaded_ += received_bytes;
+
+            CheckStalledConnection(easy);
         }
         else
         {
@@ -70,39 +122,103 @@ void HttpFileDownloader::PruneCompletedRequests()
                 results_.emplace_back(request, error_message);
         }
 
-        it = requests_.erase(it);
+        curl_multi_remove_handle(multi_, easy);
+        requests_.erase(it);
     }
 }
 
+void HttpFileDownloader::CheckStalledConnection(CURL* easy)
+{
+    if (is_connection_reuse_disabled_)
+        return;
+
+    long connects = 0;
+    curl_off_t received_bytes = 0;
+    curl_off_t start_transfer_time = 0;
+    curl_off_t total_time = 0;
+    curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &connects);
+    curl_easy_getinfo(easy, CURLINFO_SIZE_DOWNLOAD_T, &received_bytes);
+    curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME_T, &start_transfer_time);
+    curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME_T, &total_time);
+
+    // only the reused connections stall, the client acknowledges the first segments of a new connection right away
+    if (connects != 0 || received_bytes > stalled_body_max_size_)
+        return;
+
+    // the times are in microseconds
+    auto body_time = duration_cast<milliseconds>(microseconds(total_time - start_transfer_time));
+    if (body_time < stalled_body_time_)
+        return;
+
+    stalled_responses_++;
+    if (stalled_responses_ >= max_stalled_responses_)
+        is_connection_reuse_disabled_ = true;
+}
+
 void HttpFileDownloader::CreateAndAddRequest(const QueuedRequest& queued_request)
 {
     std::string file_url = base_url_ + queued_request.get_request().get_filename();
     nitro_utils::replace_all(file_url, " ", "%20");
 
-    auto shared_data = std::make_shared<RequestContext::Shared>();
-
-    auto cpr_response = cpr::GetAsync(
-        cpr::Url(file_url),
-        cpr::ConnectTimeout(connection_timeout_),
-        cpr::LowSpeed(slow_speed_threshold_, 5),
-        cpr::ProgressCallback(
-        [shared_data](cpr::cpr_off_t dn_total, cpr::cpr_off_t dn_now, cpr::cpr_off_t upld_total, cpr::cpr_off_t upld_now, intptr_t userdata)
-        {
-            if (shared_data->stop_download)
-                return false;
+    std::unique_ptr<StagingFile> staging_file;
 
-            shared_data->download_total = dn_total;
-            shared_data->download_now = dn_now;
+    if (!staging_path_.empty())
+    {
+        // a retry starts the file over
+        staging_file = std::make_unique<StagingFile>(staging_path_ / (queued_request.get_request().get_filename() + ".part"));
 
-            return true;
-        }));
+        Result open_result = staging_file->Open();
+        if (open_result.has_error())
+        {
+            results_.emplace_back(queued_request.get_request(), open_result.get_error());
+            return;
+        }
+    }
 
-    requests_.emplace_back(
+    auto request_ctx = std::make_unique<RequestContext>(
         queued_request.get_request(),
         queued_request.get_retry(),
         std::chrono::system_clock::now(),
-        shared_data,
-        std::move(cpr_response));
+        std::move(staging_file));
+
+    CURL* easy = request_ctx->get_easy();
+    if (easy == nullptr)
+    {
+        results_.emplace_back(queued_request.get_request(), std::string("Error: curl_easy_init failed"));
+        return;
+    }
+
+    curl_easy_setopt(easy, CURLOPT_URL, file_url.c_str());
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_TCP_NODELAY, 1L);
+    if (is_connection_reuse_disabled_)
+        curl_easy_setopt(easy, CURLOPT_FORBID_REUSE, 1L);
+    curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(easy, CURLOPT_MAXREDIRS, 50L);
+    curl_easy_setopt(easy, CURLOPT_SSL_OPTIONS, (long)CURLSSLOPT_NATIVE_CA);
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, (long)duration_cast<milliseconds>(connection_timeout_).count());
+    curl_easy_setopt(easy, CURLOPT_LOW_SPEED_LIMIT, (long)slow_speed_threshold_);
+    curl_easy_setopt(easy, CURLOPT_LOW_SPEED_TIME, (long)slow_speed_time_.count());
+    curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, request_ctx->get_error_buffer());
+
+    // an empty Accept-Encoding offers all the encodings libcurl is built with
+    // (gzip, and zstd and br when available) and the write function receives the data already decoded
+    curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &HttpFileDownloader::WriteFunction);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, request_ctx.get());
+    curl_easy_setopt(easy, CURLOPT_XFERINFOFUNCTION, &HttpFileDownloader::ProgressFunction);
+    curl_easy_setopt(easy, CURLOPT_XFERINFODATA, request_ctx.get());
+    curl_easy_setopt(easy, CURLOPT_NOPROGRESS, 0L);
+
+    CURLMcode add_result = curl_multi_add_handle(multi_, easy);
+    if (add_result != CURLM_OK)
+    {
+        results_.emplace_back(queued_request.get_request(), std::string("Error: ") + curl_multi_strerror(add_result));
+        return;
+    }
+
+    requests_.emplace_back(std::move(request_ctx));
 }
 
 void HttpFileDownloader::StartNewDownloads()
@@ -135,8 +251,8 @@ void HttpFileDownloader::CancelDownloads()
 {
     std::queue<QueuedRequest>().swap(files_to_download_);
 
-    for (const auto& request: requests_)
-        request.get_shared_data()->stop_download = true;
+    for (const auto& request_ctx : requests_)
+        curl_multi_remove_handle(multi_, request_ctx->get_easy());
 
     requests_.clear();
 }
@@ -147,9 +263,9 @@ uint32_t HttpFileDownloader::GetDownloadedBytes()
         requests_.cbegin(),
         requests_.cend(),
         0,
-        [](uint32_t sum, const auto& request)
+        [](uint32_t sum, const auto& request_ctx)
         {
-            return sum + request.get_shared_data()->download_now;
+            return sum + request_ctx->get_download_now();
         });
 
     uint32_t actual_bytes_downloaded = completed_requests_bytes_downloaded_ + active_downloads_bytes;
@@ -157,6 +273,20 @@ uint32_t HttpFileDownloader::GetDownloadedBytes()
     return actual_bytes_downloaded;
 }
 
+uint32_t HttpFileDownloader::GetPayloadBytes()
+{
+    uint32_t active_downloads_bytes = std::accumulate(
+        requests_.cbegin(),
+        requests_.cend(),
+        0,
+        [](uint32_t sum, const auto& request_ctx)
+        {
+            return sum + request_ctx->get_payload_now();
+        });
+
+    return completed_requests_payload_bytes_ + active_downloads_bytes;
+}
+
 std::string HttpFileDownloader::FixUrl(const std::string &url)
 {
     std::string fixed_url = url;
@@ -167,13 +297,50 @@ std::string HttpFileDownloader::FixUrl(const std::string &url)
     return fixed_url;
 }
 
-std::string HttpFileDownloader::ValidateResponseAndGetErrorMessage(const cpr::Response& response)
+std::string HttpFileDownloader::ValidateResponseAndGetErrorMessage(CURLcode result, const RequestContext& request_ctx)
 {
-    if (response.error.code != cpr::ErrorCode::OK)
-        return "Error: " + response.error.message;
+    if (result != CURLE_OK)
+    {
+        const char* error_buffer = request_ctx.get_error_buffer();
+        return std::string("Error: ") + (error_buffer[0] != '\0' ? error_buffer : curl_easy_strerror(result));
+    }
+
+    long status_code = 0;
+    curl_easy_getinfo(request_ctx.get_easy(), CURLINFO_RESPONSE_CODE, &status_code);
 
-    if (response.status_code != 200)
-        return "HTTP Code: " + std::to_string(response.status_code);
+    if (status_code != 200)
+        return "HTTP Code: " + std::to_string(status_code);
 
     return {};
 }
+
+std::string HttpFileDownloader::FinishStagingFileAndGetErrorMessage(StagingFile& staging_file, const HttpFileRequest& request)
+{
+    ResultT<std::string> hash = staging_file.Finish();
+    if (hash.has_error())
+        return "Error: " + hash.get_error();
+
+    if (!request.get_hash().empty() && *hash != request.get_hash())
+        return std::format("Hash mismatch: {}, expected {}", *hash, request.get_hash());
+
+    return {};
+}
+
+size_t HttpFileDownloader::WriteFunction(char* buffer, size_t size, size_t count, void* userdata)
+{
+    auto request_ctx = static_cast<RequestContext*>(userdata);
+
+    // returning less than the passed size aborts the transfer with a write error
+    if (!request_ctx->Write(buffer, size * count))
+        return 0;
+
+    return size * count;
+}
+
+int HttpFileDownloader::ProgressFunction(void* userdata, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow)
+{
+    auto request_ctx = static_cast<RequestContext*>(userdata);
+    request_ctx->UpdateProgress((uint32_t)dltotal, (uint32_t)dlnow);
+
+    return 0;
+}
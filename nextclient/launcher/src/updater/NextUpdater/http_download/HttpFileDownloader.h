@@ -1,42 +1,84 @@
 #pragma once
 
 #include <functional>
-#include <cpr/cpr.h>
+#include <filesystem>
+#include <memory>
+#include <queue>
+#include <curl/curl.h>
+#include <cpr/cprtypes.h>
 #include "QueuedRequest.h"
 #include "RequestContext.h"
 #include "TransferStatistics.h"
 #include "HttpFileResult.h"
 
+// Downloads the files on a curl multi handle driven by the calling thread, which sleeps in curl_multi_poll
+// until a transfer has data or completes, so the next file is started as soon as a request slot frees up.
+// The connections are reused by the next requests to the same host, unless the host stalls the reused connections.
 class HttpFileDownloader
 {
     const int max_active_requests_ = 3;
     const std::chrono::seconds connection_timeout_ = std::chrono::seconds(7);
     const int max_retries_ = 3;
     const int32_t slow_speed_threshold_ = 1024 * 10; // bytes per sec
+    const std::chrono::seconds slow_speed_time_ = std::chrono::seconds(5);
+    // the progress is reported at most this often, and at least this often while the transfers wait for data
+    const std::chrono::milliseconds progress_interval_ = std::chrono::milliseconds(50);
+    // A keep-alive server with Nagle's algorithm on holds a small body written after the headers until
+    // the headers are acknowledged, and the client delays that ACK (40 ms on Linux, up to 200 ms on Windows).
+    // After a few small responses on reused connections whose body came this late, each file gets a new connection.
+    const std::chrono::milliseconds stalled_body_time_ = std::chrono::milliseconds(30);
+    const curl_off_t stalled_body_max_size_ = 16 * 1024;
+    const int max_stalled_responses_ = 3;
 
     std::string base_url_;
+    std::filesystem::path staging_path_;
     std::function<bool(cpr::cpr_off_t downloaded, cpr::cpr_off_t speed)> progress_;
 
+    CURLM* multi_;
     std::queue<QueuedRequest> files_to_download_;
-    std::vector<RequestContext> requests_;
+    std::vector<std::unique_ptr<RequestContext>> requests_;
     std::vector<HttpFileResult> results_;
 
-    // statistics
+    int stalled_responses_{};
+    bool is_connection_reuse_disabled_{};
+
+    // statistics, the received bytes are less than the payload for the compressed responses
     cpr::cpr_off_t completed_requests_bytes_downloaded_{};
+    cpr::cpr_off_t completed_requests_payload_bytes_{};
     TransferStatistics<cpr::cpr_off_t> transfer_statistics_;
 
 public:
-    explicit HttpFileDownloader(const std::vector<HttpFileRequest>& files, const std::string& base_url, const std::function<bool(cpr::cpr_off_t downloaded, cpr::cpr_off_t speed)>& progress);
+    // If staging_path is set, each file is written to <staging_path>/<filename>.part while it is downloaded
+    // and its hash is checked against the request, otherwise the responses are kept in memory
+    explicit HttpFileDownloader(const std::vector<HttpFileRequest>& files, const std::string& base_url, const std::function<bool(cpr::cpr_off_t downloaded, cpr::cpr_off_t speed)>& progress, std::filesystem::path staging_path = {});
+    ~HttpFileDownloader();
+    HttpFileDownloader(const HttpFileDownloader&) = delete;
+    HttpFileDownloader& operator=(const HttpFileDownloader&) = delete;
+
+    // progress is called with the downloaded payload bytes and the receive speed
     [[nodiscard]] std::vector<HttpFileResult> StartDownloads();
 
+    // bytes received by the completed requests
+    [[nodiscard]] cpr::cpr_off_t get_received_bytes() const { return completed_requests_bytes_downloaded_; }
+    // decoded bytes of the completed requests
+    [[nodiscard]] cpr::cpr_off_t get_payload_bytes() const { return completed_requests_payload_bytes_; }
+    // true if the host stalled the reused connections and the files were requested on new connections
+    [[nodiscard]] bool is_connection_reuse_disabled() const { return is_connection_reuse_disabled_; }
+
 private:
     void PruneCompletedRequests();
+    void CheckStalledConnection(CURL* easy);
     void StartNewDownloads();
     void CreateAndAddRequest(const QueuedRequest& queued_request);
     bool CheckAllDownloadsCompleted();
     void UpdateTransferStatistics();
     void CancelDownloads();
     uint32_t GetDownloadedBytes();
+    uint32_t GetPayloadBytes();
     static std::string FixUrl(const std::string &url);
-    static std::string ValidateResponseAndGetErrorMessage(const cpr::Response& response);
+    static std::string ValidateResponseAndGetErrorMessage(CURLcode result, const RequestContext& request_ctx);
+    static std::string FinishStagingFileAndGetErrorMessage(StagingFile& staging_file, const HttpFileRequest& request);
+
+    static size_t WriteFunction(char* buffer, size_t size, size_t count, void* userdata);
+    static int ProgressFunction(void* userdata, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
 };
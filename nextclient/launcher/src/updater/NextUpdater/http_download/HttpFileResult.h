@@ -2,6 +2,8 @@
 
 #include <string>
 #include <utility>
+#include <vector>
+#include <filesystem>
 #include "HttpFileRequest.h"
 
 class HttpFileResult
@@ -9,6 +11,7 @@ class HttpFileResult
     HttpFileRequest request_;
     std::string error_;
     std::vector<uint8_t> data_;
+    std::filesystem::path staged_path_;
 
 public:
     explicit HttpFileResult(HttpFileRequest request, std::string error) :
@@ -21,8 +24,16 @@ public:
             data_(std::move(data))
     { }
 
+    explicit HttpFileResult(HttpFileRequest request, std::filesystem::path staged_path) :
+            request_(std::move(request)),
+            staged_path_(std::move(staged_path))
+    { }
+
     [[nodiscard]] bool has_error() const { return !error_.empty(); }
     [[nodiscard]] const std::string& get_error() const { return error_; }
     [[nodiscard]] const std::vector<uint8_t>& get_data() const { return data_; }
+    // the data is in the staged file instead of get_data()
+    [[nodiscard]] bool is_staged() const { return !staged_path_.empty(); }
+    [[nodiscard]] const std::filesystem::path& get_staged_path() const { return staged_path_; }
     [[nodiscard]] const HttpFileRequest& get_request() const { return request_; }
 };
\ No newline at end of file
@@ -1,66 +1,88 @@
 #pragma once
 
 #include <string>
-#include <queue>
-#include <future>
+#include <vector>
+#include <memory>
 #include <chrono>
 #include <utility>
-#include <cpr/api.h>
+#include <cstdint>
+#include <curl/curl.h>
+#include "HttpFileRequest.h"
+#include "StagingFile.h"
 
+// A file transfer on the curl multi handle of HttpFileDownloader.
+// The easy handle keeps pointers to the context, so the context is not movable.
 class RequestContext
 {
 public:
     using time_point = std::chrono::time_point<std::chrono::system_clock>;
 
-    struct Shared
-    {
-        std::atomic_uint32_t download_total;
-        std::atomic_uint32_t download_now;
-        std::atomic_bool stop_download = false;
-    };
-
 private:
     HttpFileRequest request_;
     int retry_{};
     time_point start_time_;
-    cpr::AsyncResponse response_;
-    std::shared_ptr<Shared> shared_data_;
+    CURL* easy_;
+    char error_buffer_[CURL_ERROR_SIZE]{};
+
+    // null if the response is kept in memory
+    std::unique_ptr<StagingFile> staging_file_;
+    std::vector<uint8_t> data_;
+
+    // received bytes, before decoding
+    uint32_t download_total_{};
+    uint32_t download_now_{};
+    // decoded bytes
+    uint32_t payload_now_{};
 
 public:
-    RequestContext(HttpFileRequest request, int retry, time_point start_time, std::shared_ptr<Shared> shared_data, cpr::AsyncResponse &&response):
+    RequestContext(HttpFileRequest request, int retry, time_point start_time, std::unique_ptr<StagingFile> staging_file) :
         request_(std::move(request)),
         retry_(retry),
         start_time_(start_time),
-        shared_data_(std::move(shared_data)),
-        response_(std::move(response))
+        easy_(curl_easy_init()),
+        staging_file_(std::move(staging_file))
     { }
 
+    ~RequestContext()
+    {
+        if (easy_ != nullptr)
+            curl_easy_cleanup(easy_);
+    }
+
     RequestContext(const RequestContext &) = delete;
     RequestContext &operator=(const RequestContext &) = delete;
 
-    RequestContext(RequestContext &&other) noexcept :
-        request_(std::move(other.request_)),
-        retry_(other.retry_),
-        start_time_(other.start_time_),
-        response_(std::move(other.response_)),
-        shared_data_(std::move(other.shared_data_))
-    { }
-
-    RequestContext &operator=(RequestContext &&other) noexcept
+    bool Write(const char* data, size_t size)
     {
-        request_ = std::move(other.request_);
-        retry_ = other.retry_;
-        start_time_ = other.start_time_;
-        response_ = std::move(other.response_);
-        shared_data_ = std::move(other.shared_data_);
+        if (staging_file_)
+        {
+            if (!staging_file_->Write(data, size))
+                return false;
+        }
+        else
+        {
+            data_.insert(data_.end(), data, data + size);
+        }
 
-        return *this;
+        payload_now_ += (uint32_t)size;
+        return true;
+    }
+
+    void UpdateProgress(uint32_t download_total, uint32_t download_now)
+    {
+        download_total_ = download_total;
+        download_now_ = download_now;
     }
 
     [[nodiscard]] time_point get_start_time() const { return start_time_; }
-    cpr::AsyncResponse& get_response() { return response_; }
+    [[nodiscard]] CURL* get_easy() const { return easy_; }
+    [[nodiscard]] const char* get_error_buffer() const { return error_buffer_; }
+    char* get_error_buffer() { return error_buffer_; }
     [[nodiscard]] const HttpFileRequest& get_request() const { return request_; }
-    [[nodiscard]] std::shared_ptr<Shared> get_shared_data() const { return shared_data_; }
+    [[nodiscard]] StagingFile* get_staging_file() const { return staging_file_.get(); }
+    std::vector<uint8_t>& get_data() { return data_; }
+    [[nodiscard]] uint32_t get_download_now() const { return download_now_; }
+    [[nodiscard]] uint32_t get_payload_now() const { return payload_now_; }
     [[nodiscard]] int get_retry() const { return retry_; }
     void set_retry(int retry) { retry_ = retry; }
 };
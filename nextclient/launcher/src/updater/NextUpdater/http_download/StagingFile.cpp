@@ -0,0 +1,45 @@
+#include "StagingFile.h"
+#include <format>
+
+namespace fs = std::filesystem;
+
+StagingFile::StagingFile(std::filesystem::path path) :
+    path_(std::move(path))
+{ }
+
+Result StagingFile::Open()
+{
+    std::error_code ec_create_directories;
+    if (path_.has_parent_path() && !fs::create_directories(path_.parent_path(), ec_create_directories) && ec_create_directories)
+        return ResultError(std::format("error on fs::create_directories at {}: {}", path_.parent_path().string(), ec_create_directories.message()));
+
+    stream_.open(path_, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!stream_.is_open())
+        return ResultError(std::format("can't open staging file {}", path_.string()));
+
+    return {};
+}
+
+bool StagingFile::Write(const char* data, size_t size)
+{
+    if (!stream_.write(data, (std::streamsize)size))
+        return false;
+
+    md5_.update(data, (MD5::size_type)size);
+    size_ += size;
+
+    return true;
+}
+
+ResultT<std::string> StagingFile::Finish()
+{
+    if (!stream_.is_open())
+        return ResultError(std::format("staging file {} is not opened", path_.string()));
+
+    stream_.close();
+    if (stream_.fail())
+        return ResultError(std::format("can't write staging file {}", path_.string()));
+
+    md5_.finalize();
+    return md5_.hexdigest();
+}
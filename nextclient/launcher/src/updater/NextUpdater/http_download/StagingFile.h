@@ -0,0 +1,32 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <data_encoding/md5.h>
+#include <utils/Result.h>
+
+// A file on disk that receives a download while it is transferred.
+// The data is hashed as it is written, so the file isn't read again to verify it.
+class StagingFile
+{
+    std::filesystem::path path_;
+    std::ofstream stream_;
+    MD5 md5_;
+    size_t size_{};
+
+public:
+    explicit StagingFile(std::filesystem::path path);
+
+    StagingFile(const StagingFile &) = delete;
+    StagingFile &operator=(const StagingFile &) = delete;
+
+    // Creates the parent folders and truncates the file
+    Result Open();
+    bool Write(const char* data, size_t size);
+    // Closes the file and returns the MD5 of the written data
+    ResultT<std::string> Finish();
+
+    [[nodiscard]] const std::filesystem::path& get_path() const { return path_; }
+    [[nodiscard]] size_t get_size() const { return size_; }
+};
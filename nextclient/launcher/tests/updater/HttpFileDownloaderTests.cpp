@@ -0,0 +1,177 @@
+#include <thread>
+#include <chrono>
+#include <iostream>
+#include <format>
+
+#include <gtest/gtest.h>
+#include <uwebsockets/App.h>
+#include <zlib.h>
+#include <data_encoding/md5.h>
+
+#include <NextUpdater/http_download/HttpFileDownloader.h>
+
+#include "NextUpdaterTestFixture.h"
+#include "KeepAliveTestServer.h"
+
+static std::string GzipCompress(const std::string& data)
+{
+    z_stream stream{};
+    // 16 + MAX_WBITS writes the gzip format
+    deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+
+    std::string compressed(deflateBound(&stream, (uLong)data.size()), '\0');
+    stream.next_in = (Bytef*)data.data();
+    stream.avail_in = (uInt)data.size();
+    stream.next_out = (Bytef*)compressed.data();
+    stream.avail_out = (uInt)compressed.size();
+
+    deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return compressed;
+}
+
+TEST_F(NextUpdaterTest, CompressedResponseIsDecodedAndStaged)
+{
+    int server_port = GetFreePort() + 5;
+
+    std::string content;
+    std::string pattern = random_string(256);
+    while (content.size() < 512 * 1024)
+        content += pattern;
+
+    std::string compressed = GzipCompress(content);
+
+    std::thread server_thread([server_port, content, compressed]{
+        uWS::App()
+        .get("/branch/test/next_engine_mini.dll", [content, compressed](auto* response, auto* request) {
+            if (request->getHeader("accept-encoding").find("gzip") != std::string_view::npos)
+                response->writeHeader("Content-Encoding", "gzip")->end(compressed);
+            else
+                response->end(content);
+        })
+        .listen(server_port, [](us_listen_socket_t* listenSocket) { })
+        .run();
+    });
+    server_thread.detach();
+
+    auto staging_path = CreateTempDir("ncl_launcher_test_staging_folder");
+
+    std::vector<HttpFileRequest> files { HttpFileRequest("next_engine_mini.dll", MD5(content).hexdigest(), content.size()) };
+    HttpFileDownloader downloader(files, std::format("http://localhost:{}/branch/test", server_port), [](cpr::cpr_off_t downloaded, cpr::cpr_off_t speed) { return false; }, staging_path);
+    std::vector<HttpFileResult> results = downloader.StartDownloads();
+
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_FALSE(results[0].has_error()) << results[0].get_error();
+    EXPECT_TRUE(results[0].is_staged());
+    EXPECT_EQ(ReadFromFile(results[0].get_staged_path()), content);
+
+    EXPECT_EQ(downloader.get_payload_bytes(), content.size());
+    EXPECT_EQ(downloader.get_received_bytes(), compressed.size());
+}
+
+TEST_F(NextUpdaterTest, ManySmallFilesAreDownloaded)
+{
+    constexpr size_t kFilesCount = 2000;
+    constexpr size_t kFileSize = 2 * 1024;
+
+    int server_port = GetFreePort() + 6;
+    std::string content = random_string(kFileSize);
+
+    std::thread server_thread([server_port, content]{
+        uWS::App()
+        .get("/branch/test/missing.dat", [](auto* response, auto* request) {
+            response->writeStatus("404 Not Found")->end();
+        })
+        .get("/branch/test/*", [content](auto* response, auto* request) {
+            response->end(content);
+        })
+        .listen(server_port, [](us_listen_socket_t* listenSocket) { })
+        .run();
+    });
+    server_thread.detach();
+
+    std::vector<HttpFileRequest> files;
+    for (size_t i = 0; i < kFilesCount; i++)
+        files.emplace_back(std::format("file_{}.dat", i), "", content.size());
+    files.emplace_back("missing.dat", "", 0);
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    HttpFileDownloader downloader(files, std::format("http://localhost:{}/branch/test", server_port), [](cpr::cpr_off_t downloaded, cpr::cpr_off_t speed) { return false; });
+    std::vector<HttpFileResult> results = downloader.StartDownloads();
+
+    double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+    ASSERT_EQ(results.size(), kFilesCount + 1);
+    for (const auto& result : results)
+    {
+        if (result.get_request().get_filename() == "missing.dat")
+        {
+            EXPECT_EQ(result.get_error(), "HTTP Code: 404");
+            continue;
+        }
+
+        EXPECT_FALSE(result.has_error()) << result.get_error();
+        EXPECT_EQ(std::string(result.get_data().begin(), result.get_data().end()), content);
+    }
+
+    EXPECT_EQ(downloader.get_payload_bytes(), kFilesCount * content.size());
+
+    std::cout << std::format("[ BENCHMARK ] {} files of {} bytes: {:.1f} ms\n", kFilesCount, kFileSize, time);
+    RecordProperty("download_ms", (int)time);
+}
+
+TEST_F(NextUpdaterTest, KeepAliveConnectionsAreReused)
+{
+    constexpr size_t kFilesCount = 100;
+
+    std::string content = random_string(2 * 1024);
+    KeepAliveTestServer server(GetFreePort() + 7, content, std::chrono::milliseconds(0));
+
+    std::vector<HttpFileRequest> files;
+    for (size_t i = 0; i < kFilesCount; i++)
+        files.emplace_back(std::format("file_{}.dat", i), MD5(content).hexdigest(), content.size());
+
+    HttpFileDownloader downloader(files, std::format("http://127.0.0.1:{}/branch/test", GetFreePort() + 7), [](cpr::cpr_off_t downloaded, cpr::cpr_off_t speed) { return false; });
+    std::vector<HttpFileResult> results = downloader.StartDownloads();
+
+    ASSERT_EQ(results.size(), kFilesCount);
+    for (const auto& result : results)
+        EXPECT_FALSE(result.has_error()) << result.get_error();
+
+    EXPECT_FALSE(downloader.is_connection_reuse_disabled());
+    EXPECT_LT(server.get_connections(), 10);
+}
+
+TEST_F(NextUpdaterTest, StalledKeepAliveConnectionsAreNotReused)
+{
+    constexpr size_t kFilesCount = 100;
+
+    // the body of a reused connection comes as late as it does from a server with Nagle's algorithm on
+    std::string content = random_string(2 * 1024);
+    KeepAliveTestServer server(GetFreePort() + 8, content, std::chrono::milliseconds(200));
+
+    std::vector<HttpFileRequest> files;
+    for (size_t i = 0; i < kFilesCount; i++)
+        files.emplace_back(std::format("file_{}.dat", i), MD5(content).hexdigest(), content.size());
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    HttpFileDownloader downloader(files, std::format("http://127.0.0.1:{}/branch/test", GetFreePort() + 8), [](cpr::cpr_off_t downloaded, cpr::cpr_off_t speed) { return false; });
+    std::vector<HttpFileResult> results = downloader.StartDownloads();
+
+    double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+    ASSERT_EQ(results.size(), kFilesCount);
+    for (const auto& result : results)
+        EXPECT_FALSE(result.has_error()) << result.get_error();
+
+    // the files after the stalled ones are requested on new connections
+    EXPECT_TRUE(downloader.is_connection_reuse_disabled());
+    EXPECT_GT(server.get_connections(), (int)kFilesCount / 2);
+
+    std::cout << std::format("[ BENCHMARK ] {} files from a stalling keep-alive server: {:.1f} ms\n", kFilesCount, time);
+    RecordProperty("download_ms", (int)time);
+}
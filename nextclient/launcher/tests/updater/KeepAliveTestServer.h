@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// HTTP/1.1 server on a plain socket, which keeps the connections alive and answers every request with the same body.
+// If body_delay is set, the body of each request after the first one on a connection is sent body_delay after
+// the headers, the way a server with Nagle's algorithm on holds it until the client acknowledges the headers.
+// uWS turns Nagle's algorithm off, so it can't serve such responses.
+class KeepAliveTestServer
+{
+#ifdef _WIN32
+    using socket_t = SOCKET;
+#else
+    using socket_t = int;
+#endif
+
+    std::shared_ptr<std::atomic<int>> connections_ = std::make_shared<std::atomic<int>>(0);
+
+public:
+    // Starts listening on 127.0.0.1, the server runs until the tests exit
+    KeepAliveTestServer(int port, std::string body, std::chrono::milliseconds body_delay)
+    {
+#ifdef _WIN32
+        WSADATA wsa_data;
+        WSAStartup(MAKEWORD(2, 2), &wsa_data);
+#endif
+
+        socket_t listen_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons((uint16_t)port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        bind(listen_socket, (sockaddr*)&address, sizeof(address));
+        listen(listen_socket, 64);
+
+        std::thread accept_thread([listen_socket, body, body_delay, connections = connections_]{
+            while (true)
+            {
+                socket_t client_socket = accept(listen_socket, nullptr, nullptr);
+                connections->fetch_add(1);
+
+                std::thread(ServeConnection, client_socket, body, body_delay).detach();
+            }
+        });
+        accept_thread.detach();
+    }
+
+    [[nodiscard]] int get_connections() const { return connections_->load(); }
+
+private:
+    static void ServeConnection(socket_t client_socket, const std::string& body, std::chrono::milliseconds body_delay)
+    {
+        std::string headers = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+        std::string request;
+        char buffer[4096];
+
+        for (int request_index = 0; ; )
+        {
+            size_t request_end = request.find("\r\n\r\n");
+            if (request_end == std::string::npos)
+            {
+                int received = recv(client_socket, buffer, sizeof(buffer), 0);
+                if (received <= 0)
+                    break;
+
+                request.append(buffer, received);
+                continue;
+            }
+
+            request.erase(0, request_end + 4);
+
+            if (request_index++ > 0 && body_delay.count() > 0)
+            {
+                send(client_socket, headers.data(), (int)headers.size(), 0);
+                std::this_thread::sleep_for(body_delay);
+                send(client_socket, body.data(), (int)body.size(), 0);
+            }
+            else
+            {
+                std::string response = headers + body;
+                send(client_socket, response.data(), (int)response.size(), 0);
+            }
+        }
+
+#ifdef _WIN32
+        closesocket(client_socket);
+#else
+        close(client_socket);
+#endif
+    }
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <format>
+#include <functional>
+#include <data_encoding/md5.h>
+#include "NextUpdaterTestFixture.h"
+
+class NextUpdaterBenchmarkTest : public NextUpdaterTest
+{
+protected:
+    // Creates the files with random content in the install folder,
+    // returns the update manifest listing them with their hashes
+    std::string CreateInstalledFiles(const std::filesystem::path& install_path, size_t files_count, size_t file_size)
+    {
+        std::string files_json;
+
+        for (size_t i = 0; i < files_count; i++)
+        {
+            std::string filename = std::format("cstrike/bench_{}/file_{}.dat", i % 16, i);
+            std::string content = random_string(file_size);
+            WriteToFile(install_path / filename, content);
+
+            if (!files_json.empty())
+                files_json += ",";
+
+            files_json += std::format(R"({{"filename": "{}", "hash": "{}", "size": {}}})", filename, MD5(content).hexdigest(), content.size());
+        }
+
+        // nothing listens on the port, the downloads fail right away
+        return std::format(R"({{"hostname": "http://localhost:1/branch/test", "files": [{}]}})", files_json);
+    }
+
+    static double MeasureMilliseconds(const std::function<void()>& func)
+    {
+        auto start_time = std::chrono::steady_clock::now();
+        func();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    }
+};
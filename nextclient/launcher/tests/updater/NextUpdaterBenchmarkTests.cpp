@@ -0,0 +1,97 @@
+#include <iostream>
+
+#include <gtest/gtest.h>
+
+#include <NextUpdater/NextUpdater.h>
+
+#include "mocks/HttpServiceMock.h"
+#include "NextUpdaterBenchmarkFixture.h"
+
+static constexpr size_t kBenchmarkFilesCount = 3000;
+static constexpr size_t kBenchmarkFileSize = 16 * 1024;
+
+TEST_F(NextUpdaterBenchmarkTest, GatherFilesWithHashCache)
+{
+    auto install_path = CreateTempDir("ncl_launcher_test_install_folder");
+    auto backup_path = CreateTempDir("ncl_launcher_test_backup_folder");
+
+    std::string manifest = CreateInstalledFiles(install_path, kBenchmarkFilesCount, kBenchmarkFileSize);
+    auto http_service = std::make_shared<HttpServiceMock>(std::unordered_map<std::string, HttpResponse> {
+        {"launcher_update", HttpResponse(200, cpr::Error(), manifest)}
+    });
+
+    auto start_updater = [&]() {
+        NextUpdater next_updater(install_path, backup_path, GetTestLogger(), http_service, [](const NextUpdaterEvent& event) { });
+        return next_updater.Start();
+    };
+
+    // the first launch hashes all the files and fills the cache
+    NextUpdaterResult cold_result{};
+    double cold_time = MeasureMilliseconds([&]() { cold_result = start_updater(); });
+
+    EXPECT_EQ(cold_result, NextUpdaterResult::NothingToUpdate);
+    EXPECT_TRUE(std::filesystem::exists(install_path / "update/file_hashes_v1.txt"));
+
+    // the next launch only checks the sizes and the write times
+    NextUpdaterResult warm_result{};
+    double warm_time = MeasureMilliseconds([&]() { warm_result = start_updater(); });
+
+    EXPECT_EQ(warm_result, NextUpdaterResult::NothingToUpdate);
+
+    std::cout << std::format("[ BENCHMARK ] {} files of {} bytes: {:.1f} ms without cache, {:.1f} ms with cache\n",
+                             kBenchmarkFilesCount, kBenchmarkFileSize, cold_time, warm_time);
+    RecordProperty("cold_ms", (int)cold_time);
+    RecordProperty("warm_ms", (int)warm_time);
+}
+
+TEST_F(NextUpdaterBenchmarkTest, ChangedFileIsHashedAgain)
+{
+    auto install_path = CreateTempDir("ncl_launcher_test_install_folder");
+    auto backup_path = CreateTempDir("ncl_launcher_test_backup_folder");
+
+    std::string manifest = CreateInstalledFiles(install_path, 16, 1024);
+    auto http_service = std::make_shared<HttpServiceMock>(std::unordered_map<std::string, HttpResponse> {
+        {"launcher_update", HttpResponse(200, cpr::Error(), manifest)}
+    });
+
+    {
+        NextUpdater next_updater(install_path, backup_path, GetTestLogger(), http_service, [](const NextUpdaterEvent& event) { });
+        EXPECT_EQ(next_updater.Start(), NextUpdaterResult::NothingToUpdate);
+    }
+
+    // no server is listening, so the update of the changed file fails and it's restored from the backup
+    WriteToFile(install_path / "cstrike/bench_0/file_0.dat", "changed content");
+
+    NextUpdater next_updater(install_path, backup_path, GetTestLogger(), http_service, [](const NextUpdaterEvent& event) { });
+    EXPECT_EQ(next_updater.Start(), NextUpdaterResult::Error);
+    EXPECT_EQ(ReadFromFile(install_path / "cstrike/bench_0/file_0.dat"), "changed content");
+}
+
+TEST_F(NextUpdaterBenchmarkTest, ChangedFileWithSameSizeIsHashedAgain)
+{
+    auto install_path = CreateTempDir("ncl_launcher_test_install_folder");
+    auto backup_path = CreateTempDir("ncl_launcher_test_backup_folder");
+
+    std::string manifest = CreateInstalledFiles(install_path, 16, 1024);
+    auto http_service = std::make_shared<HttpServiceMock>(std::unordered_map<std::string, HttpResponse> {
+        {"launcher_update", HttpResponse(200, cpr::Error(), manifest)}
+    });
+
+    {
+        NextUpdater next_updater(install_path, backup_path, GetTestLogger(), http_service, [](const NextUpdaterEvent& event) { });
+        EXPECT_EQ(next_updater.Start(), NextUpdaterResult::NothingToUpdate);
+    }
+
+    // only the write time tells the cache that the file has changed
+    auto changed_file_path = install_path / "cstrike/bench_0/file_0.dat";
+    auto write_time = std::filesystem::last_write_time(changed_file_path);
+    std::string changed_content = random_string(1024);
+    WriteToFile(changed_file_path, changed_content);
+    std::filesystem::last_write_time(changed_file_path, write_time + std::chrono::seconds(1));
+
+    ASSERT_EQ(std::filesystem::file_size(changed_file_path), changed_content.size());
+
+    NextUpdater next_updater(install_path, backup_path, GetTestLogger(), http_service, [](const NextUpdaterEvent& event) { });
+    EXPECT_EQ(next_updater.Start(), NextUpdaterResult::Error);
+    EXPECT_EQ(ReadFromFile(changed_file_path), changed_content);
+}
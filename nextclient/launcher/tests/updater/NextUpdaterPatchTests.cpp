@@ -0,0 +1,119 @@
+#include <thread>
+#include <memory>
+#include <format>
+
+#include <gtest/gtest.h>
+#include <uwebsockets/App.h>
+#include <zstd.h>
+#include <data_encoding/md5.h>
+
+#include <NextUpdater/NextUpdater.h>
+
+#include "mocks/HttpServiceMock.h"
+#include "NextUpdaterTestFixture.h"
+
+// same as `zstd --patch-from=<base> <data>` for small files
+static std::string CreatePatch(const std::string& base, const std::string& data)
+{
+    std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx(ZSTD_createCCtx(), ZSTD_freeCCtx);
+    ZSTD_CCtx_refPrefix(cctx.get(), base.data(), base.size());
+
+    std::string patch(ZSTD_compressBound(data.size()), '\0');
+    size_t patch_size = ZSTD_compress2(cctx.get(), patch.data(), patch.size(), data.data(), data.size());
+    patch.resize(ZSTD_isError(patch_size) ? 0 : patch_size);
+
+    return patch;
+}
+
+static std::string CreatePatchManifest(int server_port, const std::string& base, const std::string& data, size_t patch_size)
+{
+    return std::format(R"(
+{{
+    "hostname": "http://localhost:{}/branch/test",
+    "files":[
+        {{"filename": "next_engine_mini.dll",
+         "hash": "{}",
+         "size": {},
+         "patches": [
+            {{"base_hash": "{}",
+             "filename": "patches/next_engine_mini.dll.zst",
+             "size": {}}}
+         ]}}
+    ]
+}}
+)", server_port, MD5(data).hexdigest(), data.size(), MD5(base).hexdigest(), patch_size);
+}
+
+TEST_F(NextUpdaterTest, PatchAppliedToInstalledFile)
+{
+    // the other tests leave their servers running on GetFreePort()
+    int server_port = GetFreePort() + 1;
+
+    std::string old_content = random_string(64 * 1024);
+    std::string new_content = old_content;
+    new_content.replace(1000, 11, "new content");
+    std::string patch = CreatePatch(old_content, new_content);
+
+    std::thread server_thread([server_port, patch]{
+        uWS::App()
+        .get("/branch/test/patches/next_engine_mini.dll.zst", [patch](auto* response, auto* request) { response->end(patch); })
+        // the full file must not be downloaded when the patch applies
+        .get("/branch/test/next_engine_mini.dll", [](auto* response, auto* request) { response->end("full download"); })
+        .listen(server_port, [](us_listen_socket_t* listenSocket) { })
+        .run();
+    });
+    server_thread.detach();
+
+    auto install_path = CreateTempDir("ncl_launcher_test_install_folder");
+    auto backup_path = CreateTempDir("ncl_launcher_test_backup_folder");
+
+    WriteToFile(install_path / "next_engine_mini.dll", old_content);
+
+    auto http_service = std::make_shared<HttpServiceMock>(std::unordered_map<std::string, HttpResponse> {
+        {"launcher_update", HttpResponse(200, cpr::Error(), CreatePatchManifest(server_port, old_content, new_content, patch.size()))}
+    });
+
+    EXPECT_FALSE(patch.empty());
+    EXPECT_LT(patch.size(), new_content.size() / 10);
+
+    NextUpdater next_updater(install_path, backup_path, GetTestLogger(), http_service, [this](const NextUpdaterEvent& event) { });
+    NextUpdaterResult updater_result = next_updater.Start();
+
+    EXPECT_EQ(updater_result, NextUpdaterResult::Updated);
+    EXPECT_EQ(ReadFromFile(install_path / "next_engine_mini.dll"), new_content);
+    EXPECT_FALSE(std::filesystem::exists(backup_path));
+}
+
+TEST_F(NextUpdaterTest, BrokenPatchFallsBackToFullDownload)
+{
+    int server_port = GetFreePort() + 2;
+
+    std::string old_content = random_string(64 * 1024);
+    std::string new_content = old_content;
+    new_content.replace(1000, 11, "new content");
+    std::string patch = CreatePatch(old_content, new_content);
+
+    std::thread server_thread([server_port, new_content]{
+        uWS::App()
+        .get("/branch/test/patches/next_engine_mini.dll.zst", [](auto* response, auto* request) { response->end("not a patch"); })
+        .get("/branch/test/next_engine_mini.dll", [new_content](auto* response, auto* request) { response->end(new_content); })
+        .listen(server_port, [](us_listen_socket_t* listenSocket) { })
+        .run();
+    });
+    server_thread.detach();
+
+    auto install_path = CreateTempDir("ncl_launcher_test_install_folder");
+    auto backup_path = CreateTempDir("ncl_launcher_test_backup_folder");
+
+    WriteToFile(install_path / "next_engine_mini.dll", old_content);
+
+    auto http_service = std::make_shared<HttpServiceMock>(std::unordered_map<std::string, HttpResponse> {
+        {"launcher_update", HttpResponse(200, cpr::Error(), CreatePatchManifest(server_port, old_content, new_content, patch.size()))}
+    });
+
+    NextUpdater next_updater(install_path, backup_path, GetTestLogger(), http_service, [this](const NextUpdaterEvent& event) { });
+    NextUpdaterResult updater_result = next_updater.Start();
+
+    EXPECT_EQ(updater_result, NextUpdaterResult::Updated);
+    EXPECT_EQ(ReadFromFile(install_path / "next_engine_mini.dll"), new_content);
+}
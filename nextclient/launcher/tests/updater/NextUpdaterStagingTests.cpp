@@ -0,0 +1,88 @@
+#include <thread>
+#include <format>
+
+#include <gtest/gtest.h>
+#include <uwebsockets/App.h>
+#include <data_encoding/md5.h>
+
+#include <NextUpdater/NextUpdater.h>
+
+#include "mocks/HttpServiceMock.h"
+#include "NextUpdaterTestFixture.h"
+
+static std::string CreateManifest(int server_port, const std::string& hash, size_t size)
+{
+    return std::format(R"(
+{{
+    "hostname": "http://localhost:{}/branch/test",
+    "files":[
+        {{"filename": "next_engine_mini.dll",
+         "hash": "{}",
+         "size": {}}}
+    ]
+}}
+)", server_port, hash, size);
+}
+
+TEST_F(NextUpdaterTest, StagedDownloadWithWrongHashIsNotInstalled)
+{
+    int server_port = GetFreePort() + 3;
+
+    std::thread server_thread([server_port]{
+        uWS::App()
+        .get("/branch/test/next_engine_mini.dll", [](auto* response, auto* request) { response->end("corrupted"); })
+        .listen(server_port, [](us_listen_socket_t* listenSocket) { })
+        .run();
+    });
+    server_thread.detach();
+
+    auto install_path = CreateTempDir("ncl_launcher_test_install_folder");
+    auto backup_path = CreateTempDir("ncl_launcher_test_backup_folder");
+
+    WriteToFile(install_path / "next_engine_mini.dll", "old content");
+
+    // md5 of "aa"
+    auto http_service = std::make_shared<HttpServiceMock>(std::unordered_map<std::string, HttpResponse> {
+        {"launcher_update", HttpResponse(200, cpr::Error(), CreateManifest(server_port, "4124bc0a9335c27f086f24ba207a4912", 2))}
+    });
+
+    NextUpdater next_updater(install_path, backup_path, GetTestLogger(), http_service, [this](const NextUpdaterEvent& event) { });
+    NextUpdaterResult updater_result = next_updater.Start();
+
+    EXPECT_EQ(updater_result, NextUpdaterResult::Error);
+    EXPECT_EQ(ReadFromFile(install_path / "next_engine_mini.dll"), "old content");
+    EXPECT_FALSE(std::filesystem::exists(backup_path));
+}
+
+TEST_F(NextUpdaterTest, StagingFolderOfInterruptedUpdateIsNotRestored)
+{
+    int server_port = GetFreePort() + 4;
+
+    std::string content = random_string(256 * 1024);
+
+    std::thread server_thread([server_port, content]{
+        uWS::App()
+        .get("/branch/test/next_engine_mini.dll", [content](auto* response, auto* request) { response->end(content); })
+        .listen(server_port, [](us_listen_socket_t* listenSocket) { })
+        .run();
+    });
+    server_thread.detach();
+
+    auto install_path = CreateTempDir("ncl_launcher_test_install_folder");
+    auto backup_path = CreateTempDir("ncl_launcher_test_backup_folder");
+
+    WriteToFile(install_path / "next_engine_mini.dll", "old content");
+    WriteToFile(backup_path / "staging/next_engine_mini.dll.part", "partial download");
+
+    auto http_service = std::make_shared<HttpServiceMock>(std::unordered_map<std::string, HttpResponse> {
+        {"launcher_update", HttpResponse(200, cpr::Error(), CreateManifest(server_port, MD5(content).hexdigest(), content.size()))}
+    });
+
+    NextUpdater next_updater(install_path, backup_path, GetTestLogger(), http_service, [this](const NextUpdaterEvent& event) { });
+    NextUpdaterResult updater_result = next_updater.Start();
+
+    EXPECT_EQ(updater_result, NextUpdaterResult::Updated);
+    EXPECT_EQ(ReadFromFile(install_path / "next_engine_mini.dll"), content);
+    EXPECT_FALSE(std::filesystem::exists(install_path / "staging"));
+    EXPECT_FALSE(std::filesystem::exists(backup_path));
+}
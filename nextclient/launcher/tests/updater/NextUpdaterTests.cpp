@@ -43,10 +43,10 @@ TEST_F(NextUpdaterTest, UpdateAndInstallSuccessExpected)
          "hash": "4124bc0a9335c27f086f24ba207a4912",
          "size": 2},
         {"filename": "nitro_api.dll",
-         "hash": "21ad0bd836b90d08f4cf640b4c298e7c",
+         "hash": "e0323a9039add2978bf5b49550572c7c",
          "size": 2},
         {"filename": "cstrike/cl_dlls/client_mini.dll",
-         "hash": "e0323a9039add2978bf5b49550572c7c",
+         "hash": "21ad0bd836b90d08f4cf640b4c298e7c",
          "size": 2},
         {"filename": "cstrike/cl_dlls/GameUI.dll",
          "hash": "1aabac6d068eef6a7bad3fdf50a05cc8",
@@ -2,6 +2,7 @@
 #include <filesystem>
 #include <string>
 
+std::string random_string(size_t length);
 std::filesystem::path CreateTempDir(const std::string& prefix = "");
 void WriteToFile(const std::filesystem::path& path, const std::string& data);
 std::string ReadFromFile(const std::filesystem::path& path);